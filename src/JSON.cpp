@@ -1,10 +1,23 @@
 #include "JSON.h"
 #include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_SSE2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace JSON;
 using namespace fcl;
 
-fcl::Reaction<Null> JSON::null(std::string inp)
+fcl::Reaction<Null> JSON::null(fcl::cursor inp)
 {
 	const static auto M =
 		fcl::string("null") >>
@@ -13,7 +26,7 @@ fcl::Reaction<Null> JSON::null(std::string inp)
 	return fcl::parse(M, inp);
 }
 
-fcl::Reaction<True> JSON::bool_true(std::string inp)
+fcl::Reaction<True> JSON::bool_true(fcl::cursor inp)
 {
 	const static auto M =
 		fcl::string("true") >>
@@ -22,7 +35,7 @@ fcl::Reaction<True> JSON::bool_true(std::string inp)
 	return fcl::parse(M, inp);
 }
 
-fcl::Reaction<False> JSON::bool_false(std::string inp)
+fcl::Reaction<False> JSON::bool_false(fcl::cursor inp)
 {
 	const static auto M =
 		fcl::string("false") >>
@@ -31,7 +44,7 @@ fcl::Reaction<False> JSON::bool_false(std::string inp)
 	return fcl::parse(M, inp);
 }
 
-fcl::Reaction<std::string> JSON::integer(std::string inp)
+fcl::Reaction<std::string> JSON::integer(fcl::cursor inp)
 {
 	const static auto M =
 		maybe_one(fcl::character('-')) >>=
@@ -46,7 +59,7 @@ fcl::Reaction<std::string> JSON::integer(std::string inp)
 	return fcl::parse(M, inp);
 }
 
-fcl::Reaction<std::string> JSON::decimal(std::string inp)
+fcl::Reaction<std::string> JSON::decimal(fcl::cursor inp)
 {
 	const static auto M =
 		(fcl::character('.') >>=
@@ -57,7 +70,7 @@ fcl::Reaction<std::string> JSON::decimal(std::string inp)
 	return fcl::parse(M, inp);
 }
 
-fcl::Reaction<std::string> JSON::exponent(std::string inp)
+fcl::Reaction<std::string> JSON::exponent(fcl::cursor inp)
 {
 	const static auto M =
 		((fcl::character('e') || fcl::character('E')) >>=
@@ -70,35 +83,349 @@ fcl::Reaction<std::string> JSON::exponent(std::string inp)
 	return fcl::parse(M, inp);
 }
 
-fcl::Reaction<Number> JSON::number(std::string inp)
+namespace
 {
-	const static auto M =
-		JSON::integer >>=
-		JSON::decimal >>=
-		JSON::exponent >>=
-		Injector<Parser>::pure<function<std::string, std::string, std::string, std::string>>
-		([](std::string s1, std::string s2, std::string s3)->std::string {return s1 + s2 + s3; });
+	bool is_digit(const char* p, const char* last) { return p != last && *p >= '0' && *p <= '9'; }
+
+	//powers of ten that are exact in a double
+	const double exact_pow10[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	//a decimal literal as a digit string, value = 0.d[0]d[1]... * 10^dp
+	//it is scaled by powers of two until the mantissa bits can be read off, every step is exact
+	//except for digits past the buffer, which only decide the rounding of an exact half (Go's strconv)
+	//used where the fast path cannot round correctly, it lives on the stack and ignores the locale
+	struct big_decimal
+	{
+		static const int capacity = 800;
+		static const unsigned max_shift = 60;
+
+		unsigned char d[capacity];
+		int nd;
+		int dp;
+		bool trunc;
+
+		//[first, last) is a literal accepted by scan_number
+		big_decimal(const char* first, const char* last) :nd(0), dp(0), trunc(false)
+		{
+			const char* p = first;
+			if (*p == '-') ++p;
+			//significant digits read so far, kept or not
+			int count = 0;
+			bool point = false;
+			for (; p != last; ++p)
+			{
+				char c = *p;
+				if (c == '.')
+				{
+					point = true;
+					dp = count;
+					continue;
+				}
+				if (c < '0' || c > '9') break;
+				if (c == '0' && count == 0)
+				{
+					if (point) --dp;
+					continue;
+				}
+				if (nd < capacity) d[nd++] = static_cast<unsigned char>(c - '0');
+				else if (c != '0') trunc = true;
+				++count;
+			}
+			if (!point) dp = count;
+			if (p != last && (*p == 'e' || *p == 'E'))
+			{
+				++p;
+				bool minus = *p == '-';
+				if (*p == '-' || *p == '+') ++p;
+				int e = 0;
+				for (; p != last && *p >= '0' && *p <= '9'; ++p)
+					if (e < 100000) e = e * 10 + (*p - '0');
+				dp += minus ? -e : e;
+			}
+			trim();
+		}
+
+		void trim()
+		{
+			while (nd > 0 && d[nd - 1] == 0) --nd;
+			if (nd == 0) dp = 0;
+		}
+
+		//multiply by 2^k, k <= max_shift, digits are produced from the right
+		void left_shift(unsigned k)
+		{
+			unsigned char reversed[capacity + 20];
+			int size = 0;
+			unsigned long long n = 0;
+			for (int r = nd - 1; r >= 0; --r)
+			{
+				n += static_cast<unsigned long long>(d[r]) << k;
+				reversed[size++] = static_cast<unsigned char>(n % 10);
+				n /= 10;
+			}
+			for (; n > 0; n /= 10) reversed[size++] = static_cast<unsigned char>(n % 10);
+			dp += size - nd;
+			nd = size < capacity ? size : capacity;
+			for (int i = 0; i < size; ++i)
+			{
+				unsigned char c = reversed[size - 1 - i];
+				if (i < nd) d[i] = c;
+				else if (c != 0) trunc = true;
+			}
+			trim();
+		}
+
+		//divide by 2^k, k <= max_shift
+		void right_shift(unsigned k)
+		{
+			int r = 0;
+			int w = 0;
+			unsigned long long n = 0;
+			for (; (n >> k) == 0; ++r)
+			{
+				if (r >= nd)
+				{
+					if (n == 0)
+					{
+						nd = 0;
+						dp = 0;
+						return;
+					}
+					for (; (n >> k) == 0; ++r) n *= 10;
+					break;
+				}
+				n = n * 10 + d[r];
+			}
+			dp -= r - 1;
+			const unsigned long long mask = (1ull << k) - 1;
+			for (; r < nd; ++r)
+			{
+				unsigned char c = d[r];
+				d[w++] = static_cast<unsigned char>(n >> k);
+				n = (n & mask) * 10 + c;
+			}
+			for (; n > 0; n = (n & mask) * 10)
+			{
+				unsigned char c = static_cast<unsigned char>(n >> k);
+				if (w < capacity) d[w++] = c;
+				else if (c != 0) trunc = true;
+			}
+			nd = w;
+			trim();
+		}
+
+		//multiply by 2^k, a negative k divides
+		void shift(int k)
+		{
+			if (nd == 0) return;
+			for (; k > static_cast<int>(max_shift); k -= max_shift) left_shift(max_shift);
+			for (; k < -static_cast<int>(max_shift); k += max_shift) right_shift(max_shift);
+			if (k > 0) left_shift(k);
+			else if (k < 0) right_shift(-k);
+		}
+
+		//whether cutting the digits at n rounds up, ties go to even
+		bool round_up(int n)const
+		{
+			if (n < 0 || n >= nd) return false;
+			if (d[n] == 5 && n + 1 == nd) return trunc || (n > 0 && d[n - 1] % 2 != 0);
+			return d[n] >= 5;
+		}
+
+		unsigned long long rounded_integer()const
+		{
+			if (dp > 20) return ~0ull;
+			unsigned long long n = 0;
+			int i = 0;
+			for (; i < dp && i < nd; ++i) n = n * 10 + d[i];
+			for (; i < dp; ++i) n *= 10;
+			if (round_up(dp)) ++n;
+			return n;
+		}
+
+		//the magnitude as the nearest double
+		double value()
+		{
+			const int bias = -1023;
+			const int mantissa_bits = 52;
+			const double infinity = std::numeric_limits<double>::infinity();
+			if (nd == 0 || dp < -330) return 0.0;
+			if (dp > 310) return infinity;
+
+			//scale into [1/2, 1) with shifts that keep the digit count small
+			static const int pow_shift[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+			int exp = 0;
+			while (dp > 0)
+			{
+				int n = dp >= 9 ? 27 : pow_shift[dp];
+				shift(-n);
+				exp += n;
+			}
+			while (dp < 0 || (dp == 0 && d[0] < 5))
+			{
+				int n = -dp >= 9 ? 27 : pow_shift[-dp];
+				shift(n);
+				exp -= n;
+			}
+			//[1, 2) is the double's form, below the smallest exponent the value becomes subnormal
+			--exp;
+			if (exp < bias + 1)
+			{
+				int n = bias + 1 - exp;
+				shift(-n);
+				exp += n;
+			}
+			if (exp - bias >= 0x7FF) return infinity;
+
+			shift(1 + mantissa_bits);
+			unsigned long long mantissa = rounded_integer();
+			//rounding up can carry into another bit
+			if (mantissa == 2ull << mantissa_bits)
+			{
+				mantissa >>= 1;
+				++exp;
+				if (exp - bias >= 0x7FF) return infinity;
+			}
+			if ((mantissa & (1ull << mantissa_bits)) == 0) exp = bias;
+			unsigned long long bits = (mantissa & ((1ull << mantissa_bits) - 1)) | (static_cast<unsigned long long>(exp - bias) & 0x7FF) << mantissa_bits;
+			double result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+	};
+
+	double slow_path(const char* first, const char* last)
+	{
+		big_decimal b(first, last);
+		double d = b.value();
+		return *first == '-' ? -d : d;
+	}
+}
+
+const char* JSON::scan_number(const char* first, const char* last, Number& out)
+{
+	const char* p = first;
+	bool negative = p != last && *p == '-';
+	if (negative) ++p;
+	if (!is_digit(p, last)) return nullptr;
+
+	//up to 19 significant digits fit in the mantissa, the rest only move the exponent
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int exp10 = 0;
+	bool truncated = false;
+	auto accumulate = [&](char c, int scale)
+	{
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (c - '0');
+			if (mantissa != 0) ++digits;
+			exp10 -= scale;
+		}
+		else
+		{
+			truncated = truncated || c != '0';
+			exp10 += 1 - scale;
+		}
+	};
+
+	if (*p == '0') ++p;
+	else while (is_digit(p, last)) accumulate(*p++, 0);
+	const char* integer_end = p;
+
+	//a '.' or an 'e' not followed by digits is left in the input
+	if (p != last && *p == '.' && is_digit(p + 1, last))
+	{
+		++p;
+		while (is_digit(p, last)) accumulate(*p++, 1);
+	}
+	if (p != last && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p + 1;
+		bool minus = q != last && *q == '-';
+		if (q != last && (*q == '-' || *q == '+')) ++q;
+		if (is_digit(q, last))
+		{
+			int e = 0;
+			while (is_digit(q, last))
+			{
+				if (e < 100000) e = e * 10 + (*q - '0');
+				++q;
+			}
+			exp10 += minus ? -e : e;
+			p = q;
+		}
+	}
+
+	out.integral = false;
+	out.integer = 0;
+	const unsigned long long limit = negative ? 9223372036854775808ull : 9223372036854775807ull;
+	//digits dropped past the 19th leave exp10 above zero, such a literal is only a double
+	if (p == integer_end && exp10 == 0 && mantissa <= limit)
+	{
+		out.integral = true;
+		out.integer = negative ? static_cast<long long>(0 - mantissa) : static_cast<long long>(mantissa);
+	}
+
+	//both operands are exact, so one rounding gives the correct double (Clinger's fast path)
+	if (!truncated && mantissa <= (1ull << 53) && exp10 >= -22 && exp10 <= 22)
+	{
+		double m = static_cast<double>(mantissa);
+		out.value = exp10 < 0 ? m / exact_pow10[-exp10] : m * exact_pow10[exp10];
+		if (negative) out.value = -out.value;
+	}
+	else if (mantissa == 0) out.value = negative ? -0.0 : 0.0;
+	else out.value = slow_path(first, p);
+	return p;
+}
 
-	auto r = parse(M, inp);
-	if (isNothing(r)) return Nothing();
-	auto pair = fromJust(r);
-	return reaction(Number{ std::stof(pair.first) }, std::move(pair.second));
+fcl::Reaction<Number> JSON::number(fcl::cursor inp)
+{
+	Number n;
+	const char* end = scan_number(inp.data(), inp.end(), n);
+	if (end == nullptr) return Nothing();
+	return reaction(std::move(n), inp.drop(end - inp.data()));
 }
 
 char32_t JSON::char_to_uni(char c) { return c; }
 
-char32_t JSON::unicode(char c1, char c2, char c3, char c4) { return strtoul("" + c1 + c2 + c3 + c4, 0, 16); }
+char32_t JSON::escape_to_uni(char c)
+{
+	switch (c)
+	{
+	case 'b': return '\b';
+	case 'f': return '\f';
+	case 'n': return '\n';
+	case 'r': return '\r';
+	case 't': return '\t';
+	default: return c;
+	}
+}
+
+char32_t JSON::unicode(char c1, char c2, char c3, char c4)
+{
+	char32_t r = 0;
+	for (char c : { c1, c2, c3, c4 })
+		r = (r << 4) | (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+	return r;
+}
 
-fcl::Reaction<char32_t> JSON::character(std::string inp)
+fcl::Reaction<char32_t> JSON::character(fcl::cursor inp)
 {
 	const static Parser<char> any_except = fcl::sat
-	([](char c)->bool {return c != '\"' && c != '\\' && iscntrl(c) == 0; });
+	([](char c)->bool {return c != '\"' && c != '\\' && iscntrl(static_cast<unsigned char>(c)) == 0; });
 
 	const static Parser<char> special = fcl::sat
-	([](char c)->bool {return c == '\"' || c == '\\' || c == '/' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t'; });
+	([](char c)->bool {return c == '\"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't'; });
 
 	const static auto C2U = Injector<Parser>::pure<function<char32_t, char>>(char_to_uni);
 
+	const static auto E2U = Injector<Parser>::pure<function<char32_t, char>>(escape_to_uni);
+
 	const static Parser<char> hex = fcl::hexdecimal;
 
 	const static auto UNI = Injector<Parser>::pure<function<char32_t, char, char, char, char>>(unicode);
@@ -108,7 +435,7 @@ fcl::Reaction<char32_t> JSON::character(std::string inp)
 			C2U) ||
 			(fcl::character('\\') >>
 		((special >>=
-			C2U) ||
+			E2U) ||
 			(fcl::character('u') >>
 				hex >>=
 				hex >>=
@@ -119,180 +446,382 @@ fcl::Reaction<char32_t> JSON::character(std::string inp)
 	return parse(M, inp);
 }
 
-fcl::Reaction<String> JSON::string(std::string inp)
+namespace
 {
-	const static auto M =
-		fcl::character('\"') >>
-		fcl::any<char32_t>(JSON::character) >>=
-		fcl::character('\"') >>
-		function<fcl::list<char32_t>, fcl::list<char32_t>>(fcl::id<fcl::list<char32_t>>);
-	auto r = parse(M, inp);
-	if (isNothing(r)) return Nothing();
-	auto pair = fromJust(r);
-	return reaction(String{ std::move(pair.first) }, std::move(pair.second));
+	//a byte that ends an unescaped run: quote, backslash or a control character
+	bool special(char c) { return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20; }
+
+	unsigned first_set(unsigned mask)
+	{
+#ifdef _MSC_VER
+		unsigned long i;
+		_BitScanForward(&i, mask);
+		return i;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
 }
 
-fcl::Reaction<Value> JSON::value(std::string inp)
+const char* JSON::find_special(const char* p, const char* last)
 {
-	const static auto M =
-		(Parser<String>(JSON::string) >>=
-			function<Value, String>(JSON::boxing<String>))
-		||
-		(Parser<Number>(JSON::number) >>=
-			function<Value, Number>(JSON::boxing<Number>))
-		||
-		(Parser<Object>(JSON::object) >>=
-			function<Value, Object>(JSON::boxing<Object>))
-		||
-		(Parser<Array>(JSON::array) >>=
-			function<Value, Array>(JSON::boxing<Array>))
-		||
-		(Parser<True>(JSON::bool_true) >>=
-			function<Value, True>(JSON::boxing<True>))
-		||
-		(Parser<False>(JSON::bool_false) >>=
-			function<Value, False>(JSON::boxing<False>))
-		||
-		(Parser<Null>(JSON::null) >>=
-			function<Value, Null>(JSON::boxing<Null>));
+#ifdef __AVX2__
+	const __m256i quote32 = _mm256_set1_epi8('\"');
+	const __m256i slash32 = _mm256_set1_epi8('\\');
+	const __m256i control32 = _mm256_set1_epi8(0x1F);
+	for (; last - p >= 32; p += 32)
+	{
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+		__m256i hit = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(x, quote32), _mm256_cmpeq_epi8(x, slash32)),
+			_mm256_cmpeq_epi8(_mm256_max_epu8(x, control32), control32));
+		unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+		if (mask != 0) return p + first_set(mask);
+	}
+#endif
+#ifdef JSON_SSE2
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i slash = _mm_set1_epi8('\\');
+	const __m128i control = _mm_set1_epi8(0x1F);
+	for (; last - p >= 16; p += 16)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		//x <= 0x1F exactly when max(x, 0x1F) == 0x1F
+		__m128i hit = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash)),
+			_mm_cmpeq_epi8(_mm_max_epu8(x, control), control));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+		if (mask != 0) return p + first_set(mask);
+	}
+#endif
+	while (p != last && !special(*p)) ++p;
+	return p;
+}
 
-	return parse(M, inp);
+namespace
+{
+	void append_utf8(char32_t c, std::string& out)
+	{
+		if (c < 0x80) out += static_cast<char>(c);
+		else if (c < 0x800)
+		{
+			out += static_cast<char>(0xC0 | (c >> 6));
+			out += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			out += static_cast<char>(0xE0 | (c >> 12));
+			out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			out += static_cast<char>(0xF0 | (c >> 18));
+			out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
 }
 
-fcl::Reaction<Array> JSON::array(std::string inp)
+const char* JSON::scan_string(const char* first, const char* last, std::string& out, bool& escaped)
 {
-	const static auto M =
-		fcl::character('[') >>
-		fcl::any<Value>(
-			JSON::value >>=
-			fcl::maybe_one(fcl::character(',')) >>
-			function<Value, Value>(fcl::id<Value>)
-			) >>=
-		fcl::character(']') >>
-		function<fcl::list<Value>, fcl::list<Value>>(fcl::id<fcl::list<Value>>);
-	auto r = parse(M, inp);
-	if (isNothing(r)) return Nothing();
-	auto pair = fromJust(r);
+	escaped = false;
+	if (first == last || *first != '\"') return nullptr;
+	const char* p = first + 1;
+	while (true)
+	{
+		const char* stop = find_special(p, last);
+		out.append(p, stop);
+		if (stop == last || static_cast<unsigned char>(*stop) < 0x20) return nullptr;
+		if (*stop == '\"') return stop + 1;
+		//escapes go through JSON::character
+		escaped = true;
+		auto r = JSON::character(fcl::cursor(stop, last));
+		if (isNothing(r)) return nullptr;
+		auto pair = fromJust(std::move(r));
+		char32_t c = pair.first;
+		p = pair.second.data();
+		if (c >= 0xDC00 && c <= 0xDFFF) c = 0xFFFD;
+		else if (c >= 0xD800 && c <= 0xDBFF)
+		{
+			//a high surrogate must be followed by a \u low surrogate
+			c = 0xFFFD;
+			if (last - p >= 2 && p[0] == '\\' && p[1] == 'u')
+			{
+				auto low = JSON::character(fcl::cursor(p, last));
+				if (isNothing(low)) return nullptr;
+				auto next = fromJust(std::move(low));
+				if (next.first >= 0xDC00 && next.first <= 0xDFFF)
+				{
+					c = 0x10000 + ((pair.first - 0xD800) << 10) + (next.first - 0xDC00);
+					p = next.second.data();
+				}
+			}
+		}
+		append_utf8(c, out);
+	}
+}
 
-	return reaction(Array{ std::move(pair.first) }, std::move(pair.second));
+fcl::Reaction<String> JSON::string(fcl::cursor inp)
+{
+	std::string text;
+	bool escaped;
+	const char* end = scan_string(inp.data(), inp.end(), text, escaped);
+	if (end == nullptr) return Nothing();
+	fcl::cursor rest = inp.drop(end - inp.data());
+	if (escaped || inp.owner() == nullptr) return reaction(String(std::move(text)), std::move(rest));
+	return reaction(String(inp.data() + 1, end - 1, inp.owner()), std::move(rest));
 }
 
-fcl::pair<String, Value> JSON::pair(String str, Value val)
+//the grammar of value, array and object commits once a bracket or a key is read
+//a committed failure travels to the public entry points, which turn it into Nothing
+namespace
 {
-	return std::make_pair<String, Value>(std::move(str), std::move(val));
+	fcl::Reaction<Value> value_grammar(fcl::cursor inp);
+
+	fcl::Reaction<Array> array_grammar(fcl::cursor inp);
+
+	fcl::Reaction<Object> object_grammar(fcl::cursor inp);
 }
 
-fcl::Reaction<Object> JSON::object(std::string inp)
+namespace
 {
-	const static auto M =
-		fcl::character('{') >>
-		any<fcl::pair<String, Value>>(
-			Parser<String>(JSON::string) >>=
-			fcl::character(':') >>
-			Parser<Value>(JSON::value) >>=
-			fcl::maybe_one(fcl::character(',')) >>
-			function<fcl::pair<String, Value>, String, Value>(JSON::pair)
-			) >>=
-		fcl::character('}') >>
-		function<fcl::list<fcl::pair<String, Value>>, fcl::list<fcl::pair<String, Value>>>(fcl::id<fcl::list<fcl::pair<String, Value>>>);
+	fcl::Reaction<Value> value_grammar(fcl::cursor inp)
+	{
+		const static auto M = fcl::token<Value>(
+			(Parser<String>(JSON::string) >>=
+				function<Value, String>(JSON::boxing<String>))
+			||
+			(Parser<Number>(JSON::number) >>=
+				function<Value, Number>(JSON::boxing<Number>))
+			||
+			(Parser<Object>(object_grammar) >>=
+				function<Value, Object>(JSON::boxing<Object>))
+			||
+			(Parser<Array>(array_grammar) >>=
+				function<Value, Array>(JSON::boxing<Array>))
+			||
+			(Parser<True>(JSON::bool_true) >>=
+				function<Value, True>(JSON::boxing<True>))
+			||
+			(Parser<False>(JSON::bool_false) >>=
+				function<Value, False>(JSON::boxing<False>))
+			||
+			(Parser<Null>(JSON::null) >>=
+				function<Value, Null>(JSON::boxing<Null>)));
+
+		return parse(M, inp);
+	}
+}
+
+fcl::Reaction<Value> JSON::value(fcl::cursor inp)
+{
+	const static auto M = attempt(Parser<Value>(value_grammar));
+	return parse(M, inp);
+}
 
-	auto r = parse(M, inp);
-	if (isNothing(r)) return Nothing();
-	auto pair = fromJust(r);
+fcl::Reaction<Value> JSON::value_file(const std::string& path) { return JSON::value(fcl::map_file(path)); }
 
-	return reaction(Object{ std::move(pair.first) }, std::move(pair.second));
+namespace
+{
+	fcl::Reaction<Array> array_grammar(fcl::cursor inp)
+	{
+		const static auto M =
+			fcl::character('[') >>
+			fcl::any<Value>(
+				value_grammar >>=
+				fcl::maybe_one(fcl::character(',')) >>
+				function<Value, Value>(fcl::id<Value>)
+				) >>=
+			Parser<na>(fcl::space) >>
+			commit(fcl::character(']')) >>
+			function<fcl::list<Value>, fcl::list<Value>>(fcl::id<fcl::list<Value>>);
+		auto r = parse(M, inp);
+		if (isNothing(r)) return Nothing();
+		auto pair = fromJust(std::move(r));
+
+		return reaction(Array{ std::move(pair.first) }, std::move(pair.second));
+	}
 }
 
-//type inference for JSON types
-template<>
-struct util::type<JSON::True> { static std::string infer() { return "True"; } };
+fcl::Reaction<Array> JSON::array(fcl::cursor inp)
+{
+	const static auto M = attempt(Parser<Array>(array_grammar));
+	return parse(M, inp);
+}
 
-template<>
-struct util::type<JSON::False> { static std::string infer() { return "False"; } };
+fcl::pair<String, Value> JSON::pair(String str, Value val)
+{
+	return std::make_pair<String, Value>(std::move(str), std::move(val));
+}
 
-template<>
-struct util::type<JSON::Null> { static std::string infer() { return "Null"; } };
+namespace
+{
+	//FNV-1a
+	size_t hash_key(const char* key, size_t size)
+	{
+		unsigned long long h = 14695981039346656037ull;
+		for (size_t i = 0; i < size; ++i) h = (h ^ static_cast<unsigned char>(key[i])) * 1099511628211ull;
+		return static_cast<size_t>(h);
+	}
+
+	//objects at least this large are indexed, smaller ones are searched in order
+	const size_t indexed_size = 32;
+}
 
-template<>
-struct util::type<JSON::String> { static std::string infer() { return "String"; } };
+struct JSON::object_index
+{
+	struct slot
+	{
+		size_t hash;
+		const fcl::pair<String, Value>* member;
+	};
+
+	//linear probing over a power of two table kept at most half full
+	std::vector<slot> slots;
+	size_t count;
+
+	object_index(const fcl::list<fcl::pair<String, Value>>& members) :slots(), count(0)
+	{
+		size_t capacity = 8;
+		while (capacity < members.size() * 2) capacity *= 2;
+		slots.assign(capacity, slot{ 0, nullptr });
+		for (const auto& m : members) add(m);
+	}
+
+	//false when the table is too full to take another member
+	bool add(const fcl::pair<String, Value>& m)
+	{
+		if ((count + 1) * 2 > slots.size()) return false;
+		size_t h = hash_key(m.first.data(), m.first.size());
+		size_t i = probe(m.first.data(), m.first.size(), h);
+		//duplicate keys resolve to the first member
+		if (slots[i].member == nullptr)
+		{
+			slots[i] = slot{ h, &m };
+			++count;
+		}
+		return true;
+	}
+
+	size_t probe(const char* key, size_t size, size_t h)const
+	{
+		size_t mask = slots.size() - 1;
+		for (size_t i = h & mask;; i = (i + 1) & mask)
+		{
+			const slot& s = slots[i];
+			if (s.member == nullptr) return i;
+			if (s.hash == h && s.member->first.size() == size && std::memcmp(s.member->first.data(), key, size) == 0) return i;
+		}
+	}
+};
 
-template<>
-struct util::type<JSON::Number> { static std::string infer() { return "Number"; } };
+JSON::Object::Object() :members_(), index_() {}
 
-template<>
-struct util::type<JSON::Array> { static std::string infer() { return "Array"; } };
+JSON::Object::Object(fcl::list<fcl::pair<String, Value>> members) :members_(std::move(members)), index_() { reindex(); }
 
-template<>
-struct util::type<JSON::Object> { static std::string infer() { return "Object"; } };
+//the index points into the members of the object it was built for
+JSON::Object::Object(const Object& other) :members_(other.members_), index_() { reindex(); }
 
-template<>
-struct util::type<JSON::Value> { static std::string infer() { return "Value"; } };
+//list nodes do not move, so the index keeps pointing at the right members
+JSON::Object::Object(Object&& other) :members_(std::move(other.members_)), index_(std::move(other.index_)) {}
 
-// JSON Show implenmentations
-template<>
-struct fcl::Show<JSON::True>
+JSON::Object& JSON::Object::operator=(const Object& other)
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::True& value) { return "true"; }
-};
+	members_ = other.members_;
+	reindex();
+	return *this;
+}
 
-template<>
-struct fcl::Show<JSON::False>
+JSON::Object& JSON::Object::operator=(Object&& other)
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::False& value) { return "false"; }
-};
+	members_ = std::move(other.members_);
+	index_ = std::move(other.index_);
+	return *this;
+}
+
+JSON::Object::~Object() {}
 
-template<>
-struct fcl::Show<JSON::Null>
+void JSON::Object::reindex()
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::Null& value) { return "null"; }
-};
+	if (members_.size() >= indexed_size) index_.reset(new object_index(members_));
+	else index_.reset();
+}
 
-template<>
-struct fcl::Show<JSON::String>
+void JSON::Object::insert(String key, Value v)
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::String& value) { return fcl::Show<fcl::list<char32_t>>::show(value.value); }
-};
+	members_.push_back(JSON::pair(std::move(key), std::move(v)));
+	if (index_ == nullptr || !index_->add(members_.back())) reindex();
+}
 
-template<>
-struct fcl::Show<JSON::Number>
+void JSON::Object::assign(fcl::list<fcl::pair<String, Value>> members)
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::Number& value) { return std::to_string(value.value); }
-};
+	members_ = std::move(members);
+	reindex();
+}
 
-template<>
-struct fcl::Show<JSON::Value>
+const Value* JSON::Object::find(const char* key, size_t size)const
 {
-	using pertain = std::true_type;
-	static std::string show(const JSON::Value& value);
-};
+	if (index_ == nullptr)
+	{
+		for (const auto& m : members_)
+			if (m.first.size() == size && std::memcmp(m.first.data(), key, size) == 0) return &m.second;
+		return nullptr;
+	}
+	size_t h = hash_key(key, size);
+	const auto& s = index_->slots[index_->probe(key, size, h)];
+	return s.member == nullptr ? nullptr : &s.member->second;
+}
 
-template<>
-struct fcl::Show<JSON::Array>
+const Value* JSON::Object::find(const std::string& key)const { return find(key.data(), key.size()); }
+
+const Value* JSON::Object::find(const String& key)const { return find(key.data(), key.size()); }
+
+namespace
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::Array& value);
-};
+	fcl::Reaction<Object> object_grammar(fcl::cursor inp)
+	{
+		const static auto M =
+			fcl::character('{') >>
+			any<fcl::pair<String, Value>>(
+				fcl::token<String>(JSON::string) >>=
+				fcl::character(':') >>
+				commit(Parser<Value>(value_grammar)) >>=
+				fcl::maybe_one(fcl::character(',')) >>
+				function<fcl::pair<String, Value>, String, Value>(JSON::pair)
+				) >>=
+			Parser<na>(fcl::space) >>
+			commit(fcl::character('}')) >>
+			function<fcl::list<fcl::pair<String, Value>>, fcl::list<fcl::pair<String, Value>>>(fcl::id<fcl::list<fcl::pair<String, Value>>>);
+
+		auto r = parse(M, inp);
+		if (isNothing(r)) return Nothing();
+		auto pair = fromJust(std::move(r));
+
+		return reaction(Object(std::move(pair.first)), std::move(pair.second));
+	}
+}
 
-template<>
-struct fcl::Show<JSON::Object>
+fcl::Reaction<Object> JSON::object(fcl::cursor inp)
 {
-	using pertain = std::true_type;
-	inline static std::string show(const JSON::Object& value);
-};
+	const static auto M = attempt(Parser<Object>(object_grammar));
+	return parse(M, inp);
+}
 
 std::string fcl::Show<JSON::Value>::show(const JSON::Value & value) { return fcl::Show<JSON::VD>::show(value.value); }
 
 std::string fcl::Show<JSON::Array>::show(const JSON::Array & value) { return fcl::Show<fcl::list<JSON::Value>>::show(value.value); }
 
-std::string fcl::Show<JSON::Object>::show(const JSON::Object & value) { return fcl::Show<fcl::list<pair<JSON::String, JSON::Value>>>::show(value.value); }
+std::string fcl::Show<JSON::Object>::show(const JSON::Object & value) { return fcl::Show<fcl::list<pair<JSON::String, JSON::Value>>>::show(value.members()); }
 
 #ifdef JSON_CPP
 
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <random>
+
 template<typename a>
 void display_parse(Parser<a> p, std::string str)
 {
@@ -307,16 +836,83 @@ int main()
 	display_parse<Null>(null, "null");
 	display_parse<Number>(number, "686.97 365.24");
 	display_parse<Number>(number, "null");
+	display_parse<Number>(number, "-0.1e-2x");
+	display_parse<Number>(number, "9007199254740993");
+	display_parse<Number>(number, "1.");
+	{
+		auto scan = [](std::string s)->Number { Number n; scan_number(s.data(), s.data() + s.size(), n); return n; };
+		std::cout << std::setprecision(17);
+		std::cout << "exact: " << scan("0.30000000000000004441").value << std::endl;
+		std::cout << "many digits: " << scan("3.14159265358979323846264338327950288").value << std::endl;
+		std::cout << "overflow: " << scan("1e400").value << std::endl;
+		std::cout << "underflow: " << scan("-1e-400").value << std::endl;
+		Number i = scan("-9223372036854775808");
+		std::cout << "int64: " << i.integral << " " << i.integer << std::endl;
+		std::cout << "too large for int64: " << scan("9223372036854775808").integral << std::endl;
+		Number twenty = scan("12345678901234567890");
+		std::cout << "20 digits: " << twenty.integral << " " << twenty.value << std::endl;
+		Number e20 = scan("100000000000000000000");
+		std::cout << "1e20 written out: " << e20.integral << " " << e20.value << std::endl;
+		//halfway cases, subnormals and the edges of the range go through the big decimal path
+		for (std::string s : { "2.2250738585072011e-308", "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+			"1.7976931348623157e308", "1.7976931348623158e308", "9007199254740993.0000000000000000000001", "0.1e-99999" })
+			std::cout << "slow path " << s << ": " << scan(s).value << std::endl;
+		//every double printed with 17 digits reads back to the same bits
+		std::mt19937_64 gen(2018);
+		int same = 0;
+		const int runs = 20000;
+		for (int k = 0; k < runs; ++k)
+		{
+			unsigned long long bits = gen();
+			double d;
+			std::memcpy(&d, &bits, sizeof(d));
+			if (!std::isfinite(d)) d = 1.0 / (k + 1);
+			char buffer[32];
+			int n = std::snprintf(buffer, sizeof(buffer), "%.17g", d);
+			Number back;
+			scan_number(buffer, buffer + n, back);
+			same += std::memcmp(&back.value, &d, sizeof(d)) == 0;
+		}
+		std::cout << "17 digit round trip: " << same << "/" << runs << std::endl << std::endl;
+		std::cout << std::setprecision(6);
+	}
 	display_parse<String>(JSON::string, "\"null\"");
+	display_parse<String>(JSON::string, "\"a run longer than thirty two bytes, then \\\"an escape\\\" and more\" tail");
+	display_parse<String>(JSON::string, "\"unterminated");
+	display_parse<String>(JSON::string, "\"tab\\tnew\\nline \\u00e9 \\u20AC \\ud83d\\ude00 \\udc00\"");
 	display_parse<Array>(JSON::array, "[\"Ford\",\"BMW\",\"Fiat\"]");
 	display_parse<Array>(JSON::array, "[]");
 	display_parse<Object>(JSON::object, "{\"name\":\"John\",\"age\":30,\"cars\":[\"Ford\",\"BMW\",\"Fiat\"]}");
 	display_parse<Object>(JSON::object, "{}");
+	display_parse<Value>(JSON::value, "[[1, {\"a\": ]], 2]");
+	{
+		Object o = fromJust(JSON::object("{\"name\":\"John\",\"age\":30,\"name\":\"Jane\"}")).first;
+		std::cout << "find name: " << Show<Value>::show(*o.find("name")) << std::endl;
+		std::cout << "find age: " << Show<Value>::show(*o.find(String("age"))) << std::endl;
+		std::cout << "find missing: " << (o.find("missing") == nullptr) << std::endl;
+		std::string big = "{";
+		for (int i = 0; i < 100; ++i) big += (i ? ",\"k" : "\"k") + std::to_string(i) + "\":" + std::to_string(i);
+		Object l = fromJust(JSON::object(big + "}")).first;
+		Object c = l;
+		std::cout << "find k77 in copy: " << Show<Value>::show(*c.find("k77")) << std::endl;
+		//members added later are found straight away, across the switch from scanning to the index
+		Object grown;
+		for (int i = 0; i < 40; ++i) grown.insert(String("g" + std::to_string(i)), Value{ Number{ double(i), true, i } });
+		std::cout << "find g5, g39 after inserts: " << Show<Value>::show(*grown.find("g5")) << " " << Show<Value>::show(*grown.find("g39")) << std::endl;
+		c.assign(o.members());
+		std::cout << "find k77, name after assign: " << (c.find("k77") == nullptr) << " " << Show<Value>::show(*c.find("name")) << std::endl << std::endl;
+	}
 	display_parse<Value>(JSON::value, "\"null\"");
 	display_parse<Value>(JSON::value, "false");
 	display_parse<Value>(JSON::value, "true");
 	display_parse<Value>(JSON::value, "null");
 	display_parse<Value>(JSON::value, "686.97");
+	{
+		std::ofstream out("JSON_test.json");
+		out << "{ \"name\" : \"John\", \"cars\" : [ \"Ford\", \"BMW\" ] }\n";
+	}
+	std::cout << "parse file JSON_test.json as Value: " << std::endl << JSON::value_file("JSON_test.json") << std::endl << std::endl;
+	std::remove("JSON_test.json");
 	display_parse<Value>(JSON::value, "{\"glossary\":{\"title\":\"exampleglossary\",\"GlossDiv\":{\"title\":\"S\",\"GlossList\":{\"GlossEntry\":{\"ID\":\"SGML\",\"SortAs\":\"SGML\",\"GlossTerm\":\"StandardGeneralizedMarkupLanguage\",\"Acronym\":\"SGML\",\"Abbrev\":\"ISO8879:1986\",\"GlossDef\":{\"para\":\"Ameta-markuplanguage,usedtocreatemarkuplanguagessuchasDocBook.\",\"GlossSeeAlso\":[\"GML\",\"XML\"]},\"GlossSee\":\"markup\"}}}}}");
 
 }
@@ -11,8 +11,44 @@ namespace JSON
 	struct False {};
 	struct Null {};
 
-	struct String { fcl::list<char32_t> value; };
-	struct Number { float value; };
+	//utf-8 text, either owned or a view into an input buffer kept alive by owner
+	struct String
+	{
+		String() :owner_(), data_(""), size_(0) {}
+
+		String(std::string text)
+		{
+			auto buffer = std::make_shared<const std::string>(std::move(text));
+			data_ = buffer->data();
+			size_ = buffer->size();
+			owner_ = std::move(buffer);
+		}
+
+		String(const char* first, const char* last, std::shared_ptr<const void> owner)
+			:owner_(std::move(owner)), data_(first), size_(last - first) {}
+
+		const char* data()const { return data_; }
+
+		size_t size()const { return size_; }
+
+		std::string str()const { return std::string(data_, size_); }
+
+		bool operator==(const String& other)const { return size_ == other.size_ && std::memcmp(data_, other.data_, size_) == 0; }
+
+		bool operator!=(const String& other)const { return !(*this == other); }
+
+	private:
+		std::shared_ptr<const void> owner_;
+		const char* data_;
+		size_t size_;
+	};
+	//integral is set when the literal has no fraction or exponent and fits in integer
+	struct Number
+	{
+		double value;
+		bool integral = false;
+		long long integer = 0;
+	};
 
 	struct Array;
 	struct Object;
@@ -20,45 +56,182 @@ namespace JSON
 
 	struct Array { fcl::list<Value> value; };
 
-	struct Object { fcl::list<fcl::pair<String, Value>> value; };
+	struct object_index;
+
+	//members keep their order, lookups in large objects go through an open addressing hash index
+	//the index is built with the object and kept up to date by every mutation, so find never writes
+	//and const Objects can be shared between threads
+	struct Object
+	{
+		Object();
+		Object(fcl::list<fcl::pair<String, Value>> members);
+		Object(const Object& other);
+		Object(Object&& other);
+		Object& operator=(const Object& other);
+		Object& operator=(Object&& other);
+		~Object();
+
+		const fcl::list<fcl::pair<String, Value>>& members()const { return members_; }
+
+		//append a member, a duplicate key stays hidden behind the first one
+		void insert(String key, Value v);
+
+		//replace every member
+		void assign(fcl::list<fcl::pair<String, Value>> members);
+
+		//first member named key, nullptr if there is none
+		const Value* find(const char* key, size_t size)const;
+		const Value* find(const std::string& key)const;
+		const Value* find(const String& key)const;
+
+	private:
+		fcl::list<fcl::pair<String, Value>> members_;
+		std::unique_ptr<object_index> index_;
+
+		void reindex();
+	};
 
 	using VD = fcl::variant<String, Number, Object, Array, True, False, Null>;
 
 	struct Value { VD value; };
 
 
-	fcl::Reaction<Null> null(std::string inp);
+	fcl::Reaction<Null> null(fcl::cursor inp);
+
+	fcl::Reaction<True> bool_true(fcl::cursor inp);
 
-	fcl::Reaction<True> bool_true(std::string inp);
+	fcl::Reaction<False> bool_false(fcl::cursor inp);
 
-	fcl::Reaction<False> bool_false(std::string inp);
+	fcl::Reaction<std::string> integer(fcl::cursor inp);
 
-	fcl::Reaction<std::string> integer(std::string inp);
+	fcl::Reaction<std::string> decimal(fcl::cursor inp);
 
-	fcl::Reaction<std::string> decimal(std::string inp);
+	fcl::Reaction<std::string> exponent(fcl::cursor inp);
 
-	fcl::Reaction<std::string> exponent(std::string inp);
+	//scan a number in [first, last) into out without allocating
+	//returns the end of the literal, nullptr if there is none
+	const char* scan_number(const char* first, const char* last, Number& out);
 
-	fcl::Reaction<Number> number(std::string inp);
+	fcl::Reaction<Number> number(fcl::cursor inp);
 
 	char32_t char_to_uni(char c);
 
+	//the character named by a one letter escape such as \n
+	char32_t escape_to_uni(char c);
+
 	char32_t unicode(char c1, char c2, char c3, char c4);
 
-	fcl::Reaction<char32_t> character(std::string inp);
+	fcl::Reaction<char32_t> character(fcl::cursor inp);
 
-	fcl::Reaction<String> string(std::string inp);
+	//first quote, backslash or control byte in [first, last), last if there is none
+	//looks at 16 or 32 bytes at a time with SSE2/AVX2
+	const char* find_special(const char* first, const char* last);
+
+	//scan a quoted string in [first, last) and append its utf-8 text to out
+	//unescaped runs are found in 16 or 32 byte blocks (SSE2/AVX2) and copied in bulk
+	//\u escapes are decoded as utf-16, unpaired surrogates become U+FFFD
+	//returns the end of the closing quote, nullptr if the string is malformed
+	//escaped is set when the text differs from the raw bytes between the quotes
+	const char* scan_string(const char* first, const char* last, std::string& out, bool& escaped);
+
+	//strings without escapes are views into inp when inp has an owner, copies otherwise
+	fcl::Reaction<String> string(fcl::cursor inp);
 
 	template<typename a, typename = std::enable_if_t<fcl::variant_traits<VD>::elem<a>::value>>
 	Value boxing(a var) { return Value{ VD(std::move(var)) }; }
 
-	fcl::Reaction<Value> value(std::string inp);
+	fcl::Reaction<Value> value(fcl::cursor inp);
+
+	//parse the value held by a file, read through a memory mapping
+	fcl::Reaction<Value> value_file(const std::string& path);
 
-	fcl::Reaction<Array> array(std::string inp);
+	fcl::Reaction<Array> array(fcl::cursor inp);
 
 	fcl::pair<String, Value> pair(String str, Value val);
 
-	fcl::Reaction<Object> object(std::string inp);
+	fcl::Reaction<Object> object(fcl::cursor inp);
 }
 
+//type inference for JSON types
+template<>
+struct util::type<JSON::True> { static std::string infer() { return "True"; } };
+
+template<>
+struct util::type<JSON::False> { static std::string infer() { return "False"; } };
+
+template<>
+struct util::type<JSON::Null> { static std::string infer() { return "Null"; } };
+
+template<>
+struct util::type<JSON::String> { static std::string infer() { return "String"; } };
+
+template<>
+struct util::type<JSON::Number> { static std::string infer() { return "Number"; } };
+
+template<>
+struct util::type<JSON::Array> { static std::string infer() { return "Array"; } };
+
+template<>
+struct util::type<JSON::Object> { static std::string infer() { return "Object"; } };
+
+template<>
+struct util::type<JSON::Value> { static std::string infer() { return "Value"; } };
+
+// JSON Show implenmentations
+template<>
+struct fcl::Show<JSON::True>
+{
+	using pertain = std::true_type;
+	inline static std::string show(const JSON::True& value) { return "true"; }
+};
+
+template<>
+struct fcl::Show<JSON::False>
+{
+	using pertain = std::true_type;
+	inline static std::string show(const JSON::False& value) { return "false"; }
+};
+
+template<>
+struct fcl::Show<JSON::Null>
+{
+	using pertain = std::true_type;
+	inline static std::string show(const JSON::Null& value) { return "null"; }
+};
+
+template<>
+struct fcl::Show<JSON::String>
+{
+	using pertain = std::true_type;
+	inline static std::string show(const JSON::String& value) { return fcl::Show<std::string>::show(value.str()); }
+};
+
+template<>
+struct fcl::Show<JSON::Number>
+{
+	using pertain = std::true_type;
+	inline static std::string show(const JSON::Number& value) { return std::to_string(value.value); }
+};
+
+template<>
+struct fcl::Show<JSON::Value>
+{
+	using pertain = std::true_type;
+	static std::string show(const JSON::Value& value);
+};
+
+template<>
+struct fcl::Show<JSON::Array>
+{
+	using pertain = std::true_type;
+	static std::string show(const JSON::Array& value);
+};
+
+template<>
+struct fcl::Show<JSON::Object>
+{
+	using pertain = std::true_type;
+	static std::string show(const JSON::Object& value);
+};
+
 #endif
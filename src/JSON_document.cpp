@@ -0,0 +1,253 @@
+/*
+* JSON_document.cpp
+* implenmentation and test stub for JSON_document.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_document.h"
+
+using namespace JSON;
+
+JSON::arena::arena(size_t block_size) :blocks_(), block_size_(block_size), reserved_(0), pos_(nullptr), end_(nullptr) {}
+
+void* JSON::arena::allocate(size_t size, size_t align)
+{
+	size_t pad = (align - reinterpret_cast<uintptr_t>(pos_) % align) % align;
+	if (pos_ == nullptr || size + pad > static_cast<size_t>(end_ - pos_))
+	{
+		//oversized requests get a block of their own
+		size_t bytes = size + align > block_size_ ? size + align : block_size_;
+		blocks_.emplace_back(new char[bytes]);
+		reserved_ += bytes;
+		pos_ = blocks_.back().get();
+		end_ = pos_ + bytes;
+		pad = (align - reinterpret_cast<uintptr_t>(pos_) % align) % align;
+	}
+	void* r = pos_ + pad;
+	pos_ += pad + size;
+	return r;
+}
+
+size_t JSON::arena::reserved()const { return reserved_; }
+
+bool JSON::node::as_bool()const
+{
+	if (type != kind::boolean) throw std::exception("error: JSON node is not a boolean.");
+	return flag;
+}
+
+double JSON::node::as_number()const
+{
+	if (type != kind::number) throw std::exception("error: JSON node is not a number.");
+	return number;
+}
+
+const char* JSON::node::data()const
+{
+	if (type != kind::string) throw std::exception("error: JSON node is not a string.");
+	return chars;
+}
+
+std::string JSON::node::str()const { return std::string(data(), count); }
+
+size_t JSON::node::size()const { return type == kind::array || type == kind::object || type == kind::string ? count : 0; }
+
+const node& JSON::node::operator[](size_t i)const
+{
+	if (type != kind::array || i >= count) throw std::exception("error: JSON array index out of range.");
+	return items[i];
+}
+
+const member& JSON::node::at(size_t i)const
+{
+	if (type != kind::object || i >= count) throw std::exception("error: JSON member index out of range.");
+	return members[i];
+}
+
+const node* JSON::node::find(const std::string& key)const
+{
+	if (type != kind::object) return nullptr;
+	for (size_t i = 0; i < count; ++i)
+		if (members[i].key_size == key.size() && std::memcmp(members[i].key, key.data(), key.size()) == 0)
+			return &members[i].value;
+	return nullptr;
+}
+
+namespace
+{
+	//children are collected on scratch stacks and copied into the arena once their container closes
+	struct builder :public handler
+	{
+		struct frame { kind type; size_t start; };
+
+		arena& memory;
+		node root;
+		std::vector<frame> frames;
+		std::vector<node> values;
+		std::vector<member> members;
+
+		builder(arena& a) :memory(a), root(), frames(), values(), members() { root.type = kind::null; }
+
+		template<typename a>
+		a* copy(const a* first, size_t n)
+		{
+			if (n == 0) return nullptr;
+			a* dest = static_cast<a*>(memory.allocate(sizeof(a) * n, alignof(a)));
+			std::memcpy(dest, first, sizeof(a) * n);
+			return dest;
+		}
+
+		const char* intern(const String& s, size_t& size)
+		{
+			size = s.size();
+			char* dest = static_cast<char*>(memory.allocate(size + 1, 1));
+			std::memcpy(dest, s.data(), size);
+			dest[size] = '\0';
+			return dest;
+		}
+
+		void deliver(const node& n)
+		{
+			if (frames.empty()) root = n;
+			else if (frames.back().type == kind::array) values.push_back(n);
+			else members.back().value = n;
+		}
+
+		static node leaf(kind type)
+		{
+			node n;
+			n.type = type;
+			n.flag = false;
+			n.count = 0;
+			n.items = nullptr;
+			return n;
+		}
+
+		void null() override { deliver(leaf(kind::null)); }
+
+		void boolean(bool value) override
+		{
+			node n = leaf(kind::boolean);
+			n.flag = value;
+			deliver(n);
+		}
+
+		void number(const Number& value) override
+		{
+			node n = leaf(kind::number);
+			n.number = value.value;
+			deliver(n);
+		}
+
+		void string(const String& value) override
+		{
+			node n = leaf(kind::string);
+			n.chars = intern(value, n.count);
+			deliver(n);
+		}
+
+		void key(const String& value) override
+		{
+			member m;
+			m.key = intern(value, m.key_size);
+			m.value = leaf(kind::null);
+			members.push_back(m);
+		}
+
+		void start_object() override { frames.push_back(frame{ kind::object, members.size() }); }
+
+		void start_array() override { frames.push_back(frame{ kind::array, values.size() }); }
+
+		void end_object() override
+		{
+			size_t start = frames.back().start;
+			frames.pop_back();
+			node n = leaf(kind::object);
+			n.count = members.size() - start;
+			n.members = copy(members.data() + start, n.count);
+			members.resize(start);
+			deliver(n);
+		}
+
+		void end_array() override
+		{
+			size_t start = frames.back().start;
+			frames.pop_back();
+			node n = leaf(kind::array);
+			n.count = values.size() - start;
+			n.items = copy(values.data() + start, n.count);
+			values.resize(start);
+			deliver(n);
+		}
+	};
+}
+
+JSON::document::document(fcl::cursor inp) :arena_(), root_()
+{
+	builder b(arena_);
+	auto r = JSON::events(std::move(inp), b);
+	if (fcl::isNothing(r) || !fcl::fromJust(std::move(r)).second.empty())
+		throw std::exception("error: malformed JSON document.");
+	root_ = b.root;
+}
+
+const node& JSON::document::root()const { return root_; }
+
+size_t JSON::document::memory()const { return arena_.reserved(); }
+
+std::string fcl::Show<JSON::node>::show(const JSON::node& value)
+{
+	switch (value.type)
+	{
+	case kind::null: return "null";
+	case kind::boolean: return value.flag ? "true" : "false";
+	case kind::number: return std::to_string(value.number);
+	case kind::string: return "\"" + value.str() + "\"";
+	case kind::array:
+	{
+		std::string r = "[";
+		for (size_t i = 0; i < value.count; ++i) r += (i ? "," : "") + show(value.items[i]);
+		return r + "]";
+	}
+	default:
+	{
+		std::string r = "{";
+		for (size_t i = 0; i < value.count; ++i)
+			r += (i ? ",\"" : "\"") + std::string(value.members[i].key, value.members[i].key_size) + "\":" + show(value.members[i].value);
+		return r + "}";
+	}
+	}
+}
+
+#ifdef JSON_DOCUMENT_CPP
+
+#include <iostream>
+
+using namespace fcl;
+
+int main()
+{
+	document doc("{\"name\":\"John\", \"age\":30, \"cars\":[\"Ford\", \"BMW\", {\"model\":\"Fiat\", \"new\":false}], \"spouse\":null}");
+	const node& root = doc.root();
+	std::cout << "document: " << Show<node>::show(root) << std::endl;
+	std::cout << "members: " << root.size() << std::endl;
+	std::cout << "name: " << root.find("name")->str() << std::endl;
+	std::cout << "age: " << root.find("age")->as_number() << std::endl;
+	std::cout << "cars[2].model: " << (*root.find("cars"))[2].find("model")->str() << std::endl;
+	std::cout << "missing: " << (root.find("missing") == nullptr) << std::endl;
+	std::cout << "unicode: " << document("\"caf\\u00e9\"").root().str() << std::endl;
+
+	std::string big = "[";
+	for (int i = 0; i < 1000; ++i) big += (i ? "," : "") + std::string("{\"id\":") + std::to_string(i) + ",\"tags\":[\"a\",\"b\"]}";
+	big += "]";
+	document large(big);
+	std::cout << "large: " << large.root().size() << " items, last id " << large.root()[999].find("id")->as_number()
+		<< ", arena bytes " << large.memory() << std::endl;
+
+	try { document bad("[1, 2"); }
+	catch (std::exception& e) { std::cout << "malformed: " << e.what() << std::endl; }
+	try { root.as_number(); }
+	catch (std::exception& e) { std::cout << "wrong kind: " << e.what() << std::endl; }
+}
+
+#endif
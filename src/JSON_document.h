@@ -0,0 +1,146 @@
+/*
+*   JSON_document.h:
+*   Arena allocated JSON documents
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	a read-only alternative to JSON::Value for large documents
+*	every node, string and child array of a document is bump allocated from one arena
+*	children of an array or object are stored contiguously
+*	nodes are trivially destructible, so dropping a document only frees the arena blocks
+*	the document is built from JSON::events, so it accepts exactly what JSON::value accepts
+*
+*   Public Interface:
+*	JSON::document doc("{\"cars\":[\"Ford\",\"BMW\"]}");	//throws on malformed input
+*	const JSON::node& root = doc.root();
+*	const JSON::node* cars = root.find("cars");
+*	std::string first = (*cars)[0].str();
+*	size_t n = cars->size();
+*	size_t bytes = doc.memory();
+*
+*   Build Process:
+*   requires JSON_sax.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_DOCUMENT_
+#define _JSON_DOCUMENT_
+
+#include "JSON_sax.h"
+#include <vector>
+
+namespace JSON
+{
+	//bump allocator, memory is only returned when the arena is destroyed
+	struct arena
+	{
+		explicit arena(size_t block_size = 64 * 1024);
+
+		arena(const arena&) = delete;
+		arena(arena&&) = default;
+		arena& operator=(const arena&) = delete;
+		arena& operator=(arena&&) = default;
+
+		void* allocate(size_t size, size_t align);
+
+		//bytes reserved from the system
+		size_t reserved()const;
+
+	private:
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		size_t block_size_;
+		size_t reserved_;
+		char* pos_;
+		char* end_;
+	};
+
+	enum class kind : unsigned char { null, boolean, number, string, array, object };
+
+	struct member;
+
+	struct node
+	{
+		kind type;
+		bool flag;
+		//characters of a string, children of an array or an object
+		size_t count;
+		union
+		{
+			double number;
+			const char* chars;
+			const node* items;
+			const member* members;
+		};
+
+		bool is_null()const { return type == kind::null; }
+		bool is_bool()const { return type == kind::boolean; }
+		bool is_number()const { return type == kind::number; }
+		bool is_string()const { return type == kind::string; }
+		bool is_array()const { return type == kind::array; }
+		bool is_object()const { return type == kind::object; }
+
+		bool as_bool()const;
+		double as_number()const;
+
+		//utf-8 bytes of a string, null terminated
+		const char* data()const;
+		std::string str()const;
+
+		size_t size()const;
+
+		//i-th child of an array
+		const node& operator[](size_t i)const;
+
+		//i-th member of an object
+		const member& at(size_t i)const;
+
+		//first member of an object named key, nullptr if there is none
+		const node* find(const std::string& key)const;
+	};
+
+	struct member
+	{
+		const char* key;
+		size_t key_size;
+		node value;
+	};
+
+	struct document
+	{
+		//parse a whole value, trailing input other than whitespace is an error
+		explicit document(fcl::cursor inp);
+
+		const node& root()const;
+
+		size_t memory()const;
+
+	private:
+		arena arena_;
+		node root_;
+	};
+}
+
+template<>
+struct util::type<JSON::node> { static std::string infer() { return "Node"; } };
+
+template<>
+struct fcl::Show<JSON::node>
+{
+	using pertain = std::true_type;
+	static std::string show(const JSON::node& value);
+};
+
+#endif
@@ -0,0 +1,435 @@
+/*
+* JSON_index.cpp
+* implenmentation and test stub for JSON_index.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_index.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_INDEX_SSE2
+#include <immintrin.h>
+#endif
+#ifdef __PCLMUL__
+#include <wmmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace JSON;
+
+namespace
+{
+	typedef unsigned long long bits;
+
+	bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+	bool is_op(char c) { return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ','; }
+
+	unsigned lowest(bits x)
+	{
+#ifdef _MSC_VER
+		unsigned long i;
+		_BitScanForward64(&i, x);
+		return i;
+#else
+		return __builtin_ctzll(x);
+#endif
+	}
+
+	//one bit per byte of a 64 byte block
+	struct block_masks
+	{
+		bits backslash;
+		bits quote;
+		bits op;
+		bits space;
+	};
+
+	block_masks classify(const char* p)
+	{
+		block_masks m = { 0, 0, 0, 0 };
+#ifdef JSON_INDEX_SSE2
+		for (int k = 0; k < 4; ++k)
+		{
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+			auto eq = [&x](char c)->bits { return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8(c)))); };
+			m.backslash |= eq('\\') << 16 * k;
+			m.quote |= eq('\"') << 16 * k;
+			m.op |= (eq('{') | eq('}') | eq('[') | eq(']') | eq(':') | eq(',')) << 16 * k;
+			m.space |= (eq(' ') | eq('\t') | eq('\n') | eq('\r')) << 16 * k;
+		}
+#else
+		for (int k = 0; k < 64; ++k)
+		{
+			bits b = 1ull << k;
+			if (p[k] == '\\') m.backslash |= b;
+			else if (p[k] == '\"') m.quote |= b;
+			else if (is_op(p[k])) m.op |= b;
+			else if (is_space(p[k])) m.space |= b;
+		}
+#endif
+		return m;
+	}
+
+	//bit i of the result is the xor of bits 0..i of x
+	bits prefix_xor(bits x)
+	{
+#ifdef __PCLMUL__
+		__m128i r = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), _mm_set1_epi8(static_cast<char>(0xFF)), 0);
+		return static_cast<bits>(_mm_cvtsi128_si64(r));
+#else
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+		return x;
+#endif
+	}
+
+	//what one block hands to the next
+	struct scan_state
+	{
+		//1 when the previous block ended in an odd run of backslashes
+		bits odd_backslash;
+		//all ones when the previous block ended inside a string
+		bits in_string;
+		//1 when the previous byte was whitespace, an operator or a quote
+		bits separator;
+	};
+
+	//append the structural positions of [first, last) as offsets from base
+	//returns true if the range ends inside a string
+	bool index_range(const char* base, const char* first, const char* last, scan_state s, std::vector<size_t>& out)
+	{
+		const bits even = 0x5555555555555555ull;
+		const bits odd = ~even;
+		char tail[64];
+		for (const char* p = first; p < last; p += 64)
+		{
+			const char* block = p;
+			size_t n = last - p < 64 ? last - p : 64;
+			if (n < 64)
+			{
+				std::memcpy(tail, p, n);
+				std::memset(tail + n, ' ', 64 - n);
+				block = tail;
+			}
+			block_masks m = classify(block);
+
+			//a byte is escaped when it ends a backslash run of odd length, carries find where runs end
+			bits bs = m.backslash;
+			bits starts = bs & ~(bs << 1);
+			bits even_start_mask = even ^ s.odd_backslash;
+			bits even_starts = starts & even_start_mask;
+			bits odd_starts = starts & ~even_start_mask;
+			bits even_carries = bs + even_starts;
+			bits odd_carries = bs + odd_starts;
+			bits ends_odd = odd_carries < bs ? 1 : 0;
+			odd_carries |= s.odd_backslash;
+			s.odd_backslash = ends_odd;
+			bits escaped = ((even_carries & ~bs) & odd) | ((odd_carries & ~bs) & even);
+
+			//string interiors, opening quotes included and closing quotes excluded
+			bits quotes = m.quote & ~escaped;
+			bits in_string = prefix_xor(quotes) ^ s.in_string;
+			s.in_string = static_cast<bits>(static_cast<long long>(in_string) >> 63);
+
+			//operators outside strings, opening quotes and the first byte after a separator
+			bits structurals = (m.op & ~in_string) | quotes;
+			bits separators = structurals | m.space;
+			bits scalars = ((separators << 1) | s.separator) & ~m.space & ~in_string;
+			s.separator = separators >> 63;
+			structurals = (structurals | scalars) & ~(quotes & ~in_string);
+
+			size_t offset = p - base;
+			for (; structurals != 0; structurals &= structurals - 1) out.push_back(offset + lowest(structurals));
+		}
+		return s.in_string != 0;
+	}
+
+	//stage two, one recursive descent over the index
+	struct walker
+	{
+		const char* base;
+		const char* end;
+		const std::vector<size_t>& positions;
+		const std::shared_ptr<const void>& owner;
+		handler& h;
+		size_t i;
+
+		void fail() { throw std::exception("error: malformed JSON document."); }
+
+		char peek() { return i < positions.size() ? base[positions[i]] : '\0'; }
+
+		bool delimited(const char* p) { return p == end || is_space(*p) || is_op(*p); }
+
+		String text(const char* p)
+		{
+			std::string out;
+			bool escaped;
+			const char* e = scan_string(p, end, out, escaped);
+			if (e == nullptr) fail();
+			if (escaped || owner == nullptr) return String(std::move(out));
+			return String(p + 1, e - 1, owner);
+		}
+
+		void literal(const char* p, const char* word, size_t n)
+		{
+			if (static_cast<size_t>(end - p) < n || std::memcmp(p, word, n) != 0 || !delimited(p + n)) fail();
+		}
+
+		void value()
+		{
+			if (i >= positions.size()) fail();
+			const char* p = base + positions[i++];
+			switch (*p)
+			{
+			case '{':
+				h.start_object();
+				if (peek() == '}') ++i;
+				else while (true)
+				{
+					if (peek() != '\"') fail();
+					h.key(text(base + positions[i++]));
+					if (peek() != ':') fail();
+					++i;
+					value();
+					char c = peek();
+					++i;
+					if (c == '}') break;
+					if (c != ',') fail();
+				}
+				h.end_object();
+				break;
+			case '[':
+				h.start_array();
+				if (peek() == ']') ++i;
+				else while (true)
+				{
+					value();
+					char c = peek();
+					++i;
+					if (c == ']') break;
+					if (c != ',') fail();
+				}
+				h.end_array();
+				break;
+			case '\"':
+				h.string(text(p));
+				break;
+			case 't':
+				literal(p, "true", 4);
+				h.boolean(true);
+				break;
+			case 'f':
+				literal(p, "false", 5);
+				h.boolean(false);
+				break;
+			case 'n':
+				literal(p, "null", 4);
+				h.null();
+				break;
+			default:
+			{
+				Number n;
+				const char* e = scan_number(p, end, n);
+				if (e == nullptr || !delimited(e)) fail();
+				h.number(n);
+			}
+			}
+		}
+	};
+
+	//builds a Value tree from events
+	struct value_builder :public handler
+	{
+		struct frame
+		{
+			bool object;
+			fcl::list<Value> items;
+			fcl::list<fcl::pair<String, Value>> members;
+			String key;
+		};
+
+		std::vector<frame> frames;
+		Value root;
+
+		void deliver(Value v)
+		{
+			if (frames.empty()) root = std::move(v);
+			else if (frames.back().object) frames.back().members.push_back(JSON::pair(std::move(frames.back().key), std::move(v)));
+			else frames.back().items.push_back(std::move(v));
+		}
+
+		void null() override { deliver(boxing(Null())); }
+		void boolean(bool value) override { value ? deliver(boxing(True())) : deliver(boxing(False())); }
+		void number(const Number& value) override { deliver(boxing(value)); }
+		void string(const String& value) override { deliver(boxing(value)); }
+		void key(const String& value) override { frames.back().key = value; }
+		void start_object() override { frames.push_back(frame{ true }); }
+		void start_array() override { frames.push_back(frame{ false }); }
+
+		void end_object() override
+		{
+			Object o(std::move(frames.back().members));
+			frames.pop_back();
+			deliver(boxing(std::move(o)));
+		}
+
+		void end_array() override
+		{
+			Array a{ std::move(frames.back().items) };
+			frames.pop_back();
+			deliver(boxing(std::move(a)));
+		}
+	};
+}
+
+structural_index JSON::index_structure(fcl::cursor inp)
+{
+	structural_index r{ inp, {} };
+	index_range(inp.data(), inp.data(), inp.end(), scan_state{ 0, 0, 1 }, r.positions);
+	return r;
+}
+
+structural_index JSON::index_structure(fcl::cursor inp, pool& workers, size_t chunk_size)
+{
+	//a chunk has to move the boundary forward
+	if (chunk_size == 0) throw std::exception("error: chunk size must be at least one byte.");
+	const char* base = inp.data();
+	size_t length = inp.length();
+
+	//no chunk starts right after a backslash, so no escape crosses a boundary
+	std::vector<size_t> bounds(1, 0);
+	while (bounds.back() < length)
+	{
+		size_t next = length - bounds.back() > chunk_size ? bounds.back() + chunk_size : length;
+		while (next < length && base[next - 1] == '\\') ++next;
+		bounds.push_back(next);
+	}
+	size_t chunks = bounds.size() - 1;
+
+	auto start_state = [base, &bounds](size_t k, bool in_string)
+	{
+		char prev = k == 0 ? ' ' : base[bounds[k] - 1];
+		return scan_state{ 0, in_string ? ~0ull : 0, is_space(prev) || is_op(prev) || prev == '\"' ? 1ull : 0 };
+	};
+
+	//every chunk is first indexed as if it started outside a string
+	std::vector<std::vector<size_t>> parts(chunks);
+	std::vector<char> parity(chunks);
+	for (size_t k = 0; k < chunks; ++k)
+	{
+		workers.submit([&, k]
+		{
+			parity[k] = index_range(base, base + bounds[k], base + bounds[k + 1], start_state(k, false), parts[k]);
+		});
+	}
+	workers.wait();
+
+	//a chunk starts inside a string when the quote parity before it is odd, those are redone
+	bool in_string = false;
+	for (size_t k = 0; k < chunks; ++k)
+	{
+		if (in_string)
+		{
+			workers.submit([&, k]
+			{
+				parts[k].clear();
+				index_range(base, base + bounds[k], base + bounds[k + 1], start_state(k, true), parts[k]);
+			});
+		}
+		in_string = in_string != (parity[k] != 0);
+	}
+	workers.wait();
+
+	structural_index r{ inp, {} };
+	size_t total = 0;
+	for (const auto& part : parts) total += part.size();
+	r.positions.reserve(total);
+	for (const auto& part : parts) r.positions.insert(r.positions.end(), part.begin(), part.end());
+	return r;
+}
+
+void JSON::walk(const structural_index& index, handler& h)
+{
+	walker w{ index.input.data(), index.input.end(), index.positions, index.input.owner(), h, 0 };
+	w.value();
+	if (w.i != index.positions.size()) w.fail();
+}
+
+Value JSON::parse_indexed(fcl::cursor inp)
+{
+	value_builder b;
+	walk(index_structure(std::move(inp)), b);
+	return std::move(b.root);
+}
+
+Value JSON::parse_indexed(fcl::cursor inp, pool& workers, size_t chunk_size)
+{
+	value_builder b;
+	walk(index_structure(std::move(inp), workers, chunk_size), b);
+	return std::move(b.root);
+}
+
+#ifdef JSON_INDEX_CPP
+
+#include <iostream>
+#include <random>
+
+using namespace fcl;
+
+int main()
+{
+	std::string text = "{\"name\":\"Jo\\\\\\\"hn\", \"esc\\\\\":[\"\\\\\\\\\", \"a,b]{\"], \"age\" : 30, \"ok\":true, \"no\":false, \"none\":null, \"deep\":[[[-1.5e3]]]}";
+	structural_index i = index_structure(text);
+	std::cout << "structural characters: ";
+	for (size_t p : i.positions) std::cout << text[p];
+	std::cout << std::endl;
+
+	Value v = parse_indexed(text);
+	std::cout << "indexed: " << Show<Value>::show(v) << std::endl;
+	std::cout << "matches JSON::value: " << (Show<Value>::show(v) == Show<Value>::show(fromJust(JSON::value(text)).first)) << std::endl;
+
+	//differential test against the reference grammar, small chunks put boundaries inside strings and escapes
+	pool workers(3);
+	std::mt19937 gen(7);
+	size_t agree = 0, runs = 200;
+	for (size_t r = 0; r < runs; ++r)
+	{
+		std::string doc = "[";
+		size_t items = gen() % 40;
+		for (size_t k = 0; k < items; ++k)
+		{
+			if (k) doc += ",";
+			switch (gen() % 4)
+			{
+			case 0: doc += "{\"k\\\\\\\"\":\"a\\\\\\\\\\\\\\\"b\"}"; break;
+			case 1: doc += "[\"" + std::string(gen() % 70, 'x') + "\\\\\", 12.5e-1 ]"; break;
+			case 2: doc += "\"}]\\\",\\\\\""; break;
+			default: doc += " null ";
+			}
+		}
+		doc += "]";
+		std::string expected = Show<Value>::show(fromJust(JSON::value(doc)).first);
+		bool same = Show<Value>::show(parse_indexed(doc)) == expected;
+		same = same && Show<Value>::show(parse_indexed(doc, workers, 1 + gen() % 50)) == expected;
+		agree += same;
+	}
+	std::cout << "differential: " << agree << "/" << runs << std::endl;
+
+	for (std::string bad : { "[1 2]", "{\"a\" 1}", "[tru]", "[1]x", "\"open", "" })
+	{
+		try { parse_indexed(bad); std::cout << "accepted " << bad << std::endl; }
+		catch (std::exception& e) { std::cout << "rejected " << Show<std::string>::show(bad) << ": " << e.what() << std::endl; }
+	}
+
+	try { parse_indexed(text, workers, 0); }
+	catch (std::exception& e) { std::cout << "chunk size 0: " << e.what() << std::endl; }
+}
+
+#endif
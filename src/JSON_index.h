@@ -0,0 +1,70 @@
+/*
+*   JSON_index.h:
+*   Two stage parsing of large JSON documents through a structural index
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	stage one finds every structural position of a document: brackets, colons, commas,
+*	opening quotes and the first byte of every number or literal
+*	it works on 64 byte blocks turned into bit masks (SSE2 compares), escaped quotes are
+*	removed with carry propagation over backslash runs and string interiors are found
+*	with a prefix xor of the quote bits (a carry-less multiply when PCLMUL is enabled)
+*	the parallel form indexes chunks on a JSON::pool, guessing that no chunk starts inside
+*	a string; once the quote parity of the preceding chunks is known, wrong guesses are redone
+*	stage two walks the index and drives a JSON::handler or builds a JSON::Value
+*	JSON::value stays the reference grammar, both stages are checked against it
+*
+*   Public Interface:
+*	JSON::structural_index i = JSON::index_structure(text);
+*	JSON::structural_index j = JSON::index_structure(fcl::map_file("big.json"), workers);
+*	JSON::walk(j, handler);
+*	JSON::Value v = JSON::parse_indexed(text);
+*	JSON::Value w = JSON::parse_indexed(fcl::map_file("big.json"), workers);
+*
+*   Build Process:
+*   requires JSON_sax.h, JSON_parallel.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_INDEX_
+#define _JSON_INDEX_
+
+#include "JSON_sax.h"
+#include "JSON_parallel.h"
+
+namespace JSON
+{
+	struct structural_index
+	{
+		fcl::cursor input;
+		//offsets from input.data(), ascending
+		std::vector<size_t> positions;
+	};
+
+	structural_index index_structure(fcl::cursor inp);
+
+	//chunk_size is in bytes and has to be positive
+	structural_index index_structure(fcl::cursor inp, pool& workers, size_t chunk_size = 1 << 22);
+
+	//throws on malformed input
+	void walk(const structural_index& index, handler& h);
+
+	Value parse_indexed(fcl::cursor inp);
+
+	Value parse_indexed(fcl::cursor inp, pool& workers, size_t chunk_size = 1 << 22);
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+* JSON_parallel.cpp
+* implenmentation and test stub for JSON_parallel.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_parallel.h"
+#include <exception>
+
+using namespace JSON;
+
+JSON::pool::pool(size_t threads) :queues_(), threads_(), lock_(), ready_(), idle_(), queued_(0), pending_(0), stop_(false), next_(0)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+	for (size_t i = 0; i < threads; ++i) queues_.emplace_back(new queue());
+	for (size_t i = 0; i < threads; ++i) threads_.emplace_back(&pool::run, this, i);
+}
+
+JSON::pool::~pool()
+{
+	wait();
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		stop_ = true;
+	}
+	ready_.notify_all();
+	for (auto& t : threads_) t.join();
+}
+
+void JSON::pool::submit(std::function<void()> task)
+{
+	queue& q = *queues_[next_++ % queues_.size()];
+	{
+		std::lock_guard<std::mutex> guard(q.lock);
+		q.tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		++queued_;
+		++pending_;
+	}
+	ready_.notify_one();
+}
+
+void JSON::pool::wait()
+{
+	std::unique_lock<std::mutex> guard(lock_);
+	idle_.wait(guard, [this] { return pending_ == 0; });
+}
+
+size_t JSON::pool::size()const { return threads_.size(); }
+
+bool JSON::pool::take(size_t self, std::function<void()>& task)
+{
+	//newest from its own deque, oldest from everyone else's
+	for (size_t k = 0; k < queues_.size(); ++k)
+	{
+		queue& q = *queues_[(self + k) % queues_.size()];
+		std::lock_guard<std::mutex> guard(q.lock);
+		if (q.tasks.empty()) continue;
+		if (k == 0)
+		{
+			task = std::move(q.tasks.back());
+			q.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(q.tasks.front());
+			q.tasks.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
+
+void JSON::pool::run(size_t self)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(lock_);
+			ready_.wait(guard, [this] { return stop_ || queued_ > 0; });
+			if (queued_ == 0) return;
+			--queued_;
+		}
+		//a task was counted for this worker, it is in some deque until taken
+		std::function<void()> task;
+		while (!take(self, task)) std::this_thread::yield();
+		task();
+		std::lock_guard<std::mutex> guard(lock_);
+		if (--pending_ == 0) idle_.notify_all();
+	}
+}
+
+namespace
+{
+	void parse_chunk(fcl::cursor chunk, fcl::list<Value>& out)
+	{
+		while (!chunk.empty())
+		{
+			const char* line_end = static_cast<const char*>(std::memchr(chunk.data(), '\n', chunk.length()));
+			size_t n = line_end == nullptr ? chunk.length() : line_end - chunk.data();
+			fcl::cursor line = chunk.take(n);
+			chunk = chunk.drop(n + 1);
+			const char* p = line.data();
+			while (p != line.end() && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+			if (p == line.end()) continue;
+			auto r = JSON::value(std::move(line));
+			if (fcl::isNothing(r)) throw std::exception("error: malformed JSON record.");
+			auto pair = fcl::fromJust(std::move(r));
+			if (!pair.second.empty()) throw std::exception("error: malformed JSON record.");
+			out.push_back(std::move(pair.first));
+		}
+	}
+}
+
+fcl::list<Value> JSON::parse_lines(fcl::cursor inp, pool& workers, size_t chunk_size)
+{
+	std::vector<fcl::cursor> chunks;
+	while (!inp.empty())
+	{
+		size_t n = chunk_size < inp.length() ? chunk_size : inp.length();
+		const char* line_end = static_cast<const char*>(std::memchr(inp.data() + n, '\n', inp.length() - n));
+		n = line_end == nullptr ? inp.length() : line_end - inp.data() + 1;
+		chunks.push_back(inp.take(n));
+		inp = inp.drop(n);
+	}
+
+	std::vector<fcl::list<Value>> results(chunks.size());
+	std::vector<std::exception_ptr> errors(chunks.size());
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		workers.submit([&chunks, &results, &errors, i]
+		{
+			try { parse_chunk(chunks[i], results[i]); }
+			catch (...) { errors[i] = std::current_exception(); }
+		});
+	}
+	workers.wait();
+
+	fcl::list<Value> out;
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		if (errors[i]) std::rethrow_exception(errors[i]);
+		out.splice(out.end(), results[i]);
+	}
+	return out;
+}
+
+#ifdef JSON_PARALLEL_CPP
+
+#include <iostream>
+
+using namespace fcl;
+
+int main()
+{
+	std::string log;
+	for (int i = 0; i < 20000; ++i)
+		log += "{\"id\":" + std::to_string(i) + ", \"msg\":\"line\\n" + std::to_string(i) + "\", \"tags\":[1,2,3]}\n" + (i % 1000 == 0 ? "\n" : "");
+
+	pool workers(4);
+	std::cout << "workers: " << workers.size() << std::endl;
+
+	fcl::list<Value> records = parse_lines(log, workers, 4096);
+	using traits = variant_traits<VD>;
+	bool ordered = true;
+	long long expected = 0;
+	for (const auto& v : records)
+		ordered = ordered && traits::get<Number>(traits::get<Object>(v.value).find("id")->value).integer == expected++;
+	std::cout << "records: " << records.size() << ", in order: " << ordered << std::endl;
+	std::cout << "last: " << Show<Value>::show(records.back()) << std::endl;
+
+	std::atomic<int> count(0);
+	for (int i = 0; i < 1000; ++i) workers.submit([&count] { ++count; });
+	workers.wait();
+	std::cout << "tasks run: " << count << std::endl;
+
+	try { parse_lines("{\"a\":1}\n{\"a\":\n[1]\n", workers, 4); }
+	catch (std::exception& e) { std::cout << "malformed: " << e.what() << std::endl; }
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+*   JSON_parallel.h:
+*   Parallel parsing of newline delimited JSON
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	pool is a work stealing thread pool, every worker owns a task deque
+*	and steals from the others when its own is empty
+*	parse_lines splits the input into chunks that end on a newline, parses every chunk
+*	on the pool with JSON::value and returns the records in input order
+*	a raw newline never occurs inside a JSON record, so chunks need no further scanning
+*	the first malformed record (in input order) is rethrown after all chunks finish
+*
+*	concurrency of the JSON parsers:
+*	the combinators in JSON.cpp and parser.cpp are function local statics,
+*	C++11 guarantees their initialization happens once even when threads race to it
+*	after that they are only read: Parser and function invoke through const members,
+*	shared containers are counted atomically and shared pieces are held by std::shared_ptr
+*	so one set of static combinators serves every thread, no per thread instances needed
+*	building with _SINGLE_THREADED_ makes those counts plain and this package unsafe
+*
+*   Public Interface:
+*	JSON::pool p(8);
+*	p.submit([] { ... }); p.wait();
+*	fcl::list<JSON::Value> records = JSON::parse_lines(fcl::map_file("log.ndjson"), p);
+*
+*   Build Process:
+*   requires JSON.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_PARALLEL_
+#define _JSON_PARALLEL_
+
+#include "JSON.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace JSON
+{
+	struct pool
+	{
+		//0 picks one worker per hardware thread
+		explicit pool(size_t threads = 0);
+
+		pool(const pool&) = delete;
+		pool& operator=(const pool&) = delete;
+
+		//finishes every submitted task first
+		~pool();
+
+		//tasks must not throw
+		void submit(std::function<void()> task);
+
+		//block until every submitted task has finished
+		void wait();
+
+		size_t size()const;
+
+	private:
+		struct queue
+		{
+			std::mutex lock;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		std::vector<std::unique_ptr<queue>> queues_;
+		std::vector<std::thread> threads_;
+		std::mutex lock_;
+		std::condition_variable ready_;
+		std::condition_variable idle_;
+		size_t queued_;
+		size_t pending_;
+		bool stop_;
+		std::atomic<size_t> next_;
+
+		bool take(size_t self, std::function<void()>& task);
+		void run(size_t self);
+	};
+
+	//parse one record per line, blank lines are skipped
+	fcl::list<Value> parse_lines(fcl::cursor inp, pool& workers, size_t chunk_size = 1 << 20);
+}
+
+#endif
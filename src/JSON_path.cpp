@@ -0,0 +1,254 @@
+/*
+* JSON_path.cpp
+* implenmentation and test stub for JSON_path.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_path.h"
+
+using namespace JSON;
+
+namespace
+{
+	path::step make_step(std::string key)
+	{
+		bool digits = !key.empty() && key.find_first_not_of("0123456789") == std::string::npos;
+		//leading zeros are not indices in RFC 6901
+		bool is_index = digits && (key.size() == 1 || key[0] != '0') && key.size() < 19;
+		size_t index = is_index ? static_cast<size_t>(std::stoull(key)) : 0;
+		return path::step{ std::move(key), is_index, index };
+	}
+
+	bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+	const char* skip_space(const char* p, const char* last)
+	{
+		while (p != last && is_space(*p)) ++p;
+		return p;
+	}
+
+	const char* skip_string(const char* p, const char* last)
+	{
+		for (++p; p != last; ++p)
+		{
+			if (*p == '\\')
+			{
+				if (++p == last) return nullptr;
+			}
+			else if (*p == '\"') return p + 1;
+		}
+		return nullptr;
+	}
+
+	//end of the value at p, only quotes and brackets are looked at
+	const char* skip_value(const char* p, const char* last)
+	{
+		if (p == last) return nullptr;
+		if (*p == '\"') return skip_string(p, last);
+		if (*p == '{' || *p == '[')
+		{
+			size_t depth = 0;
+			while (p != last)
+			{
+				switch (*p)
+				{
+				case '\"':
+					p = skip_string(p, last);
+					if (p == nullptr) return nullptr;
+					continue;
+				case '{':
+				case '[':
+					++depth;
+					break;
+				case '}':
+				case ']':
+					if (--depth == 0) return p + 1;
+				}
+				++p;
+			}
+			return nullptr;
+		}
+		const char* first = p;
+		while (p != last && *p != ',' && *p != '}' && *p != ']' && !is_space(*p)) ++p;
+		return p == first ? nullptr : p;
+	}
+
+	//past the separator after a skipped member or element
+	const char* next_item(const char* p, const char* last)
+	{
+		p = skip_space(p, last);
+		if (p != last && *p == ',') ++p;
+		return p;
+	}
+}
+
+JSON::path::path() :steps_() {}
+
+JSON::path::path(std::vector<step> steps) :steps_(std::move(steps)) {}
+
+path JSON::path::pointer(const std::string& str)
+{
+	std::vector<step> steps;
+	if (str.empty()) return path(std::move(steps));
+	if (str[0] != '/') throw std::exception("error: JSON pointer must start with '/'.");
+	size_t i = 1;
+	while (true)
+	{
+		std::string key;
+		for (; i < str.size() && str[i] != '/'; ++i)
+		{
+			if (str[i] != '~') key += str[i];
+			else if (i + 1 < str.size() && (str[i + 1] == '0' || str[i + 1] == '1')) key += str[++i] == '0' ? '~' : '/';
+			else throw std::exception("error: invalid escape in JSON pointer.");
+		}
+		steps.push_back(make_step(std::move(key)));
+		if (i++ == str.size()) break;
+	}
+	return path(std::move(steps));
+}
+
+path JSON::path::dotted(const std::string& str)
+{
+	std::vector<step> steps;
+	size_t i = 0;
+	while (i < str.size())
+	{
+		if (str[i] == '[')
+		{
+			size_t close = str.find(']', i);
+			if (close == std::string::npos) throw std::exception("error: unclosed [ in JSON path.");
+			step s = make_step(str.substr(i + 1, close - i - 1));
+			if (!s.is_index) throw std::exception("error: JSON path index is not a number.");
+			steps.push_back(std::move(s));
+			i = close + 1;
+			if (i < str.size() && str[i] == '.') ++i;
+			continue;
+		}
+		size_t end = str.find_first_of(".[", i);
+		if (end == std::string::npos) end = str.size();
+		steps.push_back(make_step(str.substr(i, end - i)));
+		i = end < str.size() && str[end] == '.' ? end + 1 : end;
+	}
+	return path(std::move(steps));
+}
+
+const Value* JSON::path::eval(const Value& root)const
+{
+	using traits = fcl::variant_traits<VD>;
+	const Value* v = &root;
+	for (const auto& s : steps_)
+	{
+		if (traits::is_of<Object>(v->value)) v = traits::get<Object>(v->value).find(s.key);
+		else if (traits::is_of<Array>(v->value) && s.is_index)
+		{
+			const auto& items = traits::get<Array>(v->value).value;
+			if (s.index >= items.size()) return nullptr;
+			v = &*std::next(items.begin(), s.index);
+		}
+		else return nullptr;
+		if (v == nullptr) return nullptr;
+	}
+	return v;
+}
+
+fcl::Maybe<Value> JSON::path::extract(fcl::cursor inp)const
+{
+	const char* p = inp.data();
+	const char* last = inp.end();
+	std::string key;
+	for (const auto& s : steps_)
+	{
+		p = skip_space(p, last);
+		if (p == last) return fcl::Nothing();
+		if (*p == '{')
+		{
+			p = skip_space(p + 1, last);
+			while (true)
+			{
+				if (p == last || *p == '}') return fcl::Nothing();
+				key.clear();
+				bool escaped;
+				p = scan_string(p, last, key, escaped);
+				if (p == nullptr) return fcl::Nothing();
+				p = skip_space(p, last);
+				if (p == last || *p != ':') return fcl::Nothing();
+				p = skip_space(p + 1, last);
+				if (key == s.key) break;
+				p = skip_value(p, last);
+				if (p == nullptr) return fcl::Nothing();
+				p = skip_space(next_item(p, last), last);
+			}
+		}
+		else if (*p == '[' && s.is_index)
+		{
+			p = skip_space(p + 1, last);
+			for (size_t i = 0; i < s.index; ++i)
+			{
+				if (p == last || *p == ']') return fcl::Nothing();
+				p = skip_value(p, last);
+				if (p == nullptr) return fcl::Nothing();
+				p = skip_space(next_item(p, last), last);
+			}
+			if (p == last || *p == ']') return fcl::Nothing();
+		}
+		else return fcl::Nothing();
+	}
+	auto r = JSON::value(inp.drop(p - inp.data()));
+	if (fcl::isNothing(r)) return fcl::Nothing();
+	return std::move(fcl::fromJust(std::move(r)).first);
+}
+
+size_t JSON::path::size()const { return steps_.size(); }
+
+const path::step& JSON::path::operator[](size_t i)const { return steps_.at(i); }
+
+std::string fcl::Show<JSON::path>::show(const JSON::path& value)
+{
+	//shown as a JSON pointer
+	std::string r;
+	for (size_t i = 0; i < value.size(); ++i)
+	{
+		r += '/';
+		for (char c : value[i].key)
+		{
+			if (c == '~') r += "~0";
+			else if (c == '/') r += "~1";
+			else r += c;
+		}
+	}
+	return fcl::Show<std::string>::show(r);
+}
+
+#ifdef JSON_PATH_CPP
+
+#include <iostream>
+
+using namespace fcl;
+
+int main()
+{
+	std::string text = "{\"name\":\"John\", \"a/b\":{\"m~n\":1}, \"cars\":[{\"model\":\"Ford\"}, {\"model\":\"BMW\", \"skip\":[\"]\", {\"x\":\"}\"}]}, {\"model\":\"Fiat\"}], \"age\":30}";
+	Value doc = fromJust(JSON::value(text)).first;
+
+	path p1 = path::pointer("/cars/1/model");
+	path p2 = path::dotted("cars[2].model");
+	path p3 = path::pointer("/a~1b/m~0n");
+	path p4 = path::dotted("age");
+	path p5 = path::pointer("/cars/7");
+	std::cout << "compiled " << Show<path>::show(p1) << " " << Show<path>::show(p2) << " " << Show<path>::show(p3) << std::endl;
+
+	for (const path& p : { p1, p2, p3, p4, p5 })
+	{
+		const Value* v = p.eval(doc);
+		std::cout << "eval " << Show<path>::show(p) << ": " << (v ? Show<Value>::show(*v) : "nullptr") << std::endl;
+		std::cout << "extract " << Show<path>::show(p) << ": " << p.extract(text) << std::endl;
+	}
+
+	std::cout << "root: " << path::pointer("").extract("  [1, 2] ") << std::endl;
+	try { path::pointer("cars"); }
+	catch (std::exception& e) { std::cout << "bad pointer: " << e.what() << std::endl; }
+	try { path::dotted("cars[x]"); }
+	catch (std::exception& e) { std::cout << "bad path: " << e.what() << std::endl; }
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*
+*   JSON_path.h:
+*   Compiled JSON Pointer and dotted path queries
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	a path is compiled once into a vector of steps and reused across documents
+*	two syntaxes compile to the same steps:
+*	JSON Pointer (RFC 6901): "/cars/0/model", with ~0 for '~' and ~1 for '/'
+*	dotted paths: "cars[0].model" or "cars.0.model"
+*	a step names an object member, or an array element when it is a decimal index
+*	eval walks a parsed Value
+*	extract walks raw text and only parses the value the path ends at
+*	every subtree off the path is skipped by matching brackets and quotes, it is neither
+*	materialized nor validated
+*
+*   Public Interface:
+*	JSON::path p = JSON::path::pointer("/cars/0");
+*	JSON::path q = JSON::path::dotted("cars[0]");
+*	const JSON::Value* v = p.eval(value);				//nullptr if nothing matches
+*	fcl::Maybe<JSON::Value> w = q.extract(text);		//Nothing if nothing matches
+*	size_t n = p.size();
+*
+*   Build Process:
+*   requires JSON.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_PATH_
+#define _JSON_PATH_
+
+#include "JSON.h"
+#include <vector>
+
+namespace JSON
+{
+	struct path
+	{
+		struct step
+		{
+			//member name, unescaped
+			std::string key;
+			//the key is a decimal array index
+			bool is_index;
+			size_t index;
+		};
+
+		path();
+
+		explicit path(std::vector<step> steps);
+
+		//throws on a pointer that is neither empty nor starts with '/', and on bad ~ escapes
+		static path pointer(const std::string& str);
+
+		//throws on an unclosed or non-numeric [index]
+		static path dotted(const std::string& str);
+
+		const Value* eval(const Value& root)const;
+
+		fcl::Maybe<Value> extract(fcl::cursor inp)const;
+
+		size_t size()const;
+
+		const step& operator[](size_t i)const;
+
+	private:
+		std::vector<step> steps_;
+	};
+}
+
+template<>
+struct util::type<JSON::path> { static std::string infer() { return "Path"; } };
+
+template<>
+struct fcl::Show<JSON::path>
+{
+	using pertain = std::true_type;
+	static std::string show(const JSON::path& value);
+};
+
+#endif
@@ -0,0 +1,250 @@
+/*
+* JSON_sax.cpp
+* implenmentation and test stub for JSON_sax.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_sax.h"
+
+using namespace JSON;
+using namespace fcl;
+
+namespace
+{
+	//fcl::space never fails
+	cursor skip_space(cursor inp) { return fromJust(fcl::space(std::move(inp))).second; }
+
+	bool peek(const cursor& inp, char c) { return !inp.empty() && inp.head() == c; }
+
+	//run a leaf parser and hand its result to emit
+	template<typename a, typename f>
+	Maybe<cursor> leaf(Reaction<a>(*p)(cursor), cursor inp, f emit)
+	{
+		auto r = p(std::move(inp));
+		if (isNothing(r)) return Nothing();
+		auto pair = fromJust(std::move(r));
+		emit(pair.first);
+		return std::move(pair.second);
+	}
+
+	Maybe<cursor> value_events(cursor inp, handler& h);
+
+	//'{' (key ':' value ','?)* '}' as in JSON::object
+	Maybe<cursor> object_events(cursor inp, handler& h)
+	{
+		h.start_object();
+		inp = inp.tail();
+		while (true)
+		{
+			inp = skip_space(std::move(inp));
+			if (peek(inp, '}')) break;
+			auto k = leaf<String>(JSON::string, std::move(inp), [&h](const String& s) { h.key(s); });
+			if (isNothing(k)) return Nothing();
+			inp = skip_space(fromJust(std::move(k)));
+			if (!peek(inp, ':')) return Nothing();
+			auto v = value_events(inp.tail(), h);
+			if (isNothing(v)) return Nothing();
+			inp = fromJust(std::move(v));
+			if (peek(inp, ',')) inp = inp.tail();
+		}
+		h.end_object();
+		return inp.tail();
+	}
+
+	//'[' (value ','?)* ']' as in JSON::array
+	Maybe<cursor> array_events(cursor inp, handler& h)
+	{
+		h.start_array();
+		inp = inp.tail();
+		while (true)
+		{
+			inp = skip_space(std::move(inp));
+			if (peek(inp, ']')) break;
+			auto v = value_events(std::move(inp), h);
+			if (isNothing(v)) return Nothing();
+			inp = fromJust(std::move(v));
+			if (peek(inp, ',')) inp = inp.tail();
+		}
+		h.end_array();
+		return inp.tail();
+	}
+
+	//the alternatives of JSON::value start with distinct characters, so one look ahead picks the branch
+	Maybe<cursor> value_events(cursor inp, handler& h)
+	{
+		inp = skip_space(std::move(inp));
+		if (inp.empty()) return Nothing();
+		Maybe<cursor> r;
+		switch (inp.head())
+		{
+		case '{':
+			r = object_events(std::move(inp), h);
+			break;
+		case '[':
+			r = array_events(std::move(inp), h);
+			break;
+		case '\"':
+			r = leaf<String>(JSON::string, std::move(inp), [&h](const String& s) { h.string(s); });
+			break;
+		case 't':
+			r = leaf<True>(JSON::bool_true, std::move(inp), [&h](const True&) { h.boolean(true); });
+			break;
+		case 'f':
+			r = leaf<False>(JSON::bool_false, std::move(inp), [&h](const False&) { h.boolean(false); });
+			break;
+		case 'n':
+			r = leaf<Null>(JSON::null, std::move(inp), [&h](const Null&) { h.null(); });
+			break;
+		default:
+			r = leaf<Number>(JSON::number, std::move(inp), [&h](const Number& n) { h.number(n); });
+		}
+		if (isNothing(r)) return Nothing();
+		return skip_space(fromJust(std::move(r)));
+	}
+}
+
+fcl::Reaction<fcl::na> JSON::events(fcl::cursor inp, handler& h)
+{
+	auto r = value_events(std::move(inp), h);
+	if (isNothing(r)) return Nothing();
+	return reaction(na(), fromJust(std::move(r)));
+}
+
+#ifdef JSON_SAX_CPP
+
+#include <iostream>
+#include <random>
+
+//prints every event on its own line
+struct printer :public handler
+{
+	void null() override { std::cout << "null" << std::endl; }
+	void boolean(bool value) override { std::cout << "boolean " << value << std::endl; }
+	void number(const Number& value) override { std::cout << "number " << value.value << std::endl; }
+	void string(const String& value) override { std::cout << "string " << Show<String>::show(value) << std::endl; }
+	void key(const String& value) override { std::cout << "key " << Show<String>::show(value) << std::endl; }
+	void start_object() override { std::cout << "start_object" << std::endl; }
+	void end_object() override { std::cout << "end_object" << std::endl; }
+	void start_array() override { std::cout << "start_array" << std::endl; }
+	void end_array() override { std::cout << "end_array" << std::endl; }
+};
+
+//sums every number without building a tree
+struct summer :public handler
+{
+	double total = 0;
+	size_t count = 0;
+	void number(const Number& value) override { total += value.value; ++count; }
+};
+
+//builds a Value tree from events, to compare with JSON::value
+struct value_builder :public handler
+{
+	struct frame
+	{
+		bool object;
+		fcl::list<Value> items;
+		fcl::list<fcl::pair<String, Value>> members;
+		String key;
+	};
+
+	std::vector<frame> frames;
+	Value root;
+
+	void deliver(Value v)
+	{
+		if (frames.empty()) root = std::move(v);
+		else if (frames.back().object) frames.back().members.push_back(JSON::pair(std::move(frames.back().key), std::move(v)));
+		else frames.back().items.push_back(std::move(v));
+	}
+
+	void null() override { deliver(boxing(Null())); }
+	void boolean(bool value) override { value ? deliver(boxing(True())) : deliver(boxing(False())); }
+	void number(const Number& value) override { deliver(boxing(value)); }
+	void string(const String& value) override { deliver(boxing(value)); }
+	void key(const String& value) override { frames.back().key = value; }
+	void start_object() override { frames.push_back(frame{ true }); }
+	void start_array() override { frames.push_back(frame{ false }); }
+
+	void end_object() override
+	{
+		Object o(std::move(frames.back().members));
+		frames.pop_back();
+		deliver(boxing(std::move(o)));
+	}
+
+	void end_array() override
+	{
+		Array a{ std::move(frames.back().items) };
+		frames.pop_back();
+		deliver(boxing(std::move(a)));
+	}
+};
+
+//a random document in the shapes the grammar allows, optional commas and spaces included
+std::string random_value(std::mt19937& gen, int depth)
+{
+	auto space = [&gen]() { return std::string(gen() % 3 == 0 ? " \n" : ""); };
+	auto comma = [&gen]() { return std::string(gen() % 4 == 0 ? "" : ","); };
+	static const char* const leaves[] = { "null", "true", "false", "0", "-12.5e3", "7", "\"\"", "\"a\\\"b\"", "\"\\u00e9\"" };
+	std::string v;
+	switch (depth > 3 ? 2 : gen() % 3)
+	{
+	case 0:
+	{
+		v = "{";
+		for (unsigned k = gen() % 4; k != 0; --k) v += space() + "\"k" + std::to_string(gen() % 3) + "\"" + space() + ":" + random_value(gen, depth + 1) + comma();
+		v += space() + "}";
+		break;
+	}
+	case 1:
+	{
+		v = "[";
+		for (unsigned k = gen() % 4; k != 0; --k) v += random_value(gen, depth + 1) + comma();
+		v += space() + "]";
+		break;
+	}
+	default:
+		v = leaves[gen() % (sizeof(leaves) / sizeof(leaves[0]))];
+	}
+	return space() + v + space();
+}
+
+int main()
+{
+	printer p;
+	std::cout << "events: " << events("{\"name\":\"John\", \"age\":30, \"cars\":[\"Ford\", true, null]}", p) << std::endl;
+
+	summer s;
+	events("[1, 2.5, {\"x\": [3, 4]}, \"5\", 6e1]", s);
+	std::cout << "sum of " << s.count << " numbers: " << s.total << std::endl;
+
+	summer bad;
+	std::cout << "malformed: " << events("[1, 2, {\"x\" 3}]", bad) << " after " << bad.count << " numbers" << std::endl;
+
+	//events restates the combinator grammar by hand, so it is checked against JSON::value
+	//on random documents and on the same documents with one character broken
+	std::mt19937 gen(7);
+	size_t agree = 0, runs = 2000;
+	for (size_t r = 0; r < runs; ++r)
+	{
+		std::string doc = random_value(gen, 0);
+		if (r % 2 && !doc.empty())
+		{
+			static const char broken[] = "{}[]\",: 1tx\\";
+			size_t at = gen() % doc.size();
+			if (gen() % 2) doc.erase(at, 1);
+			else doc[at] = broken[gen() % (sizeof(broken) - 1)];
+		}
+		value_builder b;
+		auto e = events(doc, b);
+		auto v = JSON::value(doc);
+		bool same = isNothing(e) == isNothing(v);
+		if (same && isJust(e))
+			same = fromJust(e).second.length() == fromJust(v).second.length() && Show<Value>::show(b.root) == Show<Value>::show(fromJust(v).first);
+		agree += same;
+	}
+	std::cout << "differential: " << agree << "/" << runs << std::endl;
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+*   JSON_sax.h:
+*   Event driven JSON parsing
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	a hand written recursive descent that restates the grammar of JSON::value, JSON::object
+*	and JSON::array, it reports what it sees to a handler instead of building a Value tree
+*	a change to that grammar has to be made here as well, the test stub compares both on random input
+*	scalars are read with the JSON leaf parsers (string, number, true, false, null)
+*	on malformed input the events up to the error have been delivered and Nothing is returned
+*
+*   Public Interface:
+*	struct counter :public JSON::handler { void number(const JSON::Number& n) override { ... } };
+*	counter c;
+*	fcl::Reaction<fcl::na> r = JSON::events("{\"a\":[1,2]}", c);
+*
+*   Build Process:
+*   requires JSON.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_SAX_
+#define _JSON_SAX_
+
+#include "JSON.h"
+
+namespace JSON
+{
+	//event callbacks, every event defaults to doing nothing
+	struct handler
+	{
+		virtual void null() {}
+		virtual void boolean(bool value) {}
+		virtual void number(const Number& value) {}
+		virtual void string(const String& value) {}
+		virtual void key(const String& value) {}
+		virtual void start_object() {}
+		virtual void end_object() {}
+		virtual void start_array() {}
+		virtual void end_array() {}
+		virtual ~handler() {}
+	};
+
+	//report the value at the front of inp to h, surrounding whitespace is consumed
+	fcl::Reaction<fcl::na> events(fcl::cursor inp, handler& h);
+}
+
+#endif
@@ -0,0 +1,201 @@
+/*
+* JSON_stream.cpp
+* implenmentation and test stub for JSON_stream.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_stream.h"
+#include <cctype>
+
+using namespace JSON;
+
+JSON::scanner::scanner() { reset(); }
+
+void JSON::scanner::reset()
+{
+	depth_ = 0;
+	in_string_ = false;
+	escaped_ = false;
+	in_literal_ = false;
+	open_ = false;
+}
+
+bool JSON::scanner::open()const { return open_; }
+
+bool JSON::scanner::pending_literal()const { return in_literal_; }
+
+const char* JSON::scanner::scan(const char* first, const char* last)
+{
+	for (const char* p = first; p != last; ++p)
+	{
+		char c = *p;
+		if (in_string_)
+		{
+			if (escaped_) escaped_ = false;
+			else if (c == '\\') escaped_ = true;
+			else if (c == '\"')
+			{
+				in_string_ = false;
+				if (depth_ == 0)
+				{
+					open_ = false;
+					return p + 1;
+				}
+			}
+			continue;
+		}
+		if (in_literal_)
+		{
+			//the delimiter belongs to whatever comes next
+			if (isspace(static_cast<unsigned char>(c)) || c == '{' || c == '[' || c == '}' || c == ']' || c == '\"' || c == ',')
+			{
+				in_literal_ = false;
+				open_ = false;
+				return p;
+			}
+			continue;
+		}
+		switch (c)
+		{
+		case '\"':
+			in_string_ = true;
+			open_ = true;
+			break;
+		case '{':
+		case '[':
+			++depth_;
+			open_ = true;
+			break;
+		case '}':
+		case ']':
+			if (depth_ > 0 && --depth_ == 0)
+			{
+				open_ = false;
+				return p + 1;
+			}
+			if (depth_ == 0)
+			{
+				//a stray closing bracket is left for JSON::value to reject
+				open_ = false;
+				return p + 1;
+			}
+			break;
+		default:
+			if (depth_ == 0 && !isspace(static_cast<unsigned char>(c)))
+			{
+				in_literal_ = true;
+				open_ = true;
+			}
+		}
+	}
+	return nullptr;
+}
+
+JSON::reader::reader() :buffer_(), scanned_(0), scanner_() {}
+
+size_t JSON::reader::buffered()const { return buffer_.size(); }
+
+bool JSON::reader::emit(const char* first, const char* last, fcl::list<Value>& out)
+{
+	//the record is parsed in place, Value copies everything it keeps out of the buffer
+	auto r = JSON::value(fcl::cursor(first, last));
+	if (fcl::isNothing(r)) return false;
+	auto pair = fcl::fromJust(std::move(r));
+	if (!pair.second.empty()) return false;
+	out.push_back(std::move(pair.first));
+	return true;
+}
+
+fcl::list<Value> JSON::reader::feed(const char* data, size_t size)
+{
+	fcl::list<Value> out;
+	if (size != 0) buffer_.append(data, size);
+	const char* begin = buffer_.data();
+	const char* record = begin;
+	const char* end = begin + buffer_.size();
+	const char* p = begin + scanned_;
+	while (p != end)
+	{
+		const char* close = scanner_.scan(p, end);
+		if (close == nullptr) break;
+		if (!emit(record, close, out))
+		{
+			//the scanner stopped at the end of the bad record, so it starts afresh on what follows
+			buffer_.erase(0, close - begin);
+			scanned_ = 0;
+			throw stream_error(std::move(out));
+		}
+		record = p = close;
+	}
+	//only the open record is kept, whitespace between records is dropped
+	if (scanner_.open()) buffer_.erase(0, record - begin);
+	else buffer_.clear();
+	scanned_ = buffer_.size();
+	return out;
+}
+
+fcl::list<Value> JSON::reader::feed(const std::string& chunk) { return feed(chunk.data(), chunk.size()); }
+
+fcl::list<Value> JSON::reader::finish()
+{
+	//input left unscanned by a failed feed goes first
+	fcl::list<Value> out = feed(nullptr, 0);
+	bool literal = scanner_.pending_literal();
+	bool open = scanner_.open();
+	bool parsed = literal && emit(buffer_.data(), buffer_.data() + buffer_.size(), out);
+	//the reader starts over whether or not the last record was good
+	buffer_.clear();
+	scanned_ = 0;
+	scanner_.reset();
+	if (literal && !parsed) throw stream_error(std::move(out));
+	if (open && !literal) throw std::exception("error: unexpected end of JSON stream.");
+	return out;
+}
+
+#ifdef JSON_STREAM_CPP
+
+#include <iostream>
+
+using namespace fcl;
+
+void display_values(std::string label, const fcl::list<Value>& values)
+{
+	std::cout << label << ": " << values.size() << " value(s)" << std::endl;
+	for (const auto& v : values) std::cout << "  " << fcl::Show<Value>::show(v) << std::endl;
+}
+
+int main()
+{
+	reader rd;
+	display_values("feed {\"a\":1}\\n{\"b\"", rd.feed("{\"a\":1}\n{\"b\""));
+	std::cout << "buffered: " << rd.buffered() << std::endl;
+	display_values("feed : [1, 2, \"]\"]}\\n", rd.feed(": [1, 2, \"]\"]}\n"));
+	std::cout << "buffered: " << rd.buffered() << std::endl;
+	display_values("feed \"esc\\\\\"aped\" 12", rd.feed("\"esc\\\"aped\" 12"));
+	display_values("feed .5 true\\n", rd.feed(".5 true\n"));
+	display_values("feed nu", rd.feed("nu"));
+	display_values("feed ll 7", rd.feed("ll 7"));
+	display_values("finish", rd.finish());
+
+	//one character at a time
+	std::string doc = "{\"name\":\"John\", \"cars\":[\"Ford\",\"BMW\"]}\n[{}]\n";
+	size_t count = 0;
+	for (char c : doc) count += rd.feed(&c, 1).size();
+	std::cout << "byte by byte: " << count << " value(s), buffered " << rd.buffered() << std::endl;
+
+	rd.feed("{\"open\":");
+	try { rd.finish(); }
+	catch (std::exception& e) { std::cout << "finish on open record: " << e.what() << std::endl; }
+
+	//the bad record is dropped, the values before it come with the error and the ones after it stay buffered
+	try { rd.feed("[1] {\"a\" 2} [3] 4"); }
+	catch (stream_error& e) { display_values("malformed record, kept", e.values); }
+	display_values("next feed", rd.feed("\n"));
+
+	//a closing bracket ends a bare literal
+	try { rd.feed("5] 6\n"); }
+	catch (stream_error& e) { display_values("literal then ], kept", e.values); }
+	display_values("finish", rd.finish());
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+*   JSON_stream.h:
+*   A resumable JSON front-end for chunked input
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	scanner tracks nesting, strings and escapes across chunk boundaries
+*	so the end of a top level value is found without parsing it
+*	reader keeps only the unfinished record between feeds and hands every
+*	completed record to JSON::value, so memory is bounded by the largest record
+*	top level values may be separated by any whitespace (newline delimited JSON included)
+*	a malformed record is thrown as stream_error with the values completed before it,
+*	the reader drops the record and carries on after it on the next feed
+*
+*   Public Interface:
+*	JSON::reader rd;
+*	fcl::list<JSON::Value> vs = rd.feed("{\"a\":1}\n{\"a\"");
+*	fcl::list<JSON::Value> ws = rd.feed(":2}\n3");
+*	fcl::list<JSON::Value> xs = rd.finish();	//flushes the trailing 3
+*	size_t n = rd.buffered();
+*
+*   Build Process:
+*   requires JSON.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_STREAM_
+#define _JSON_STREAM_
+
+#include "JSON.h"
+
+namespace JSON
+{
+	//finds where top level values end, one character at a time
+	struct scanner
+	{
+		scanner();
+
+		//scan [first, last) and return the end of the first top level value closed in it
+		//nullptr if the value is still open at last
+		const char* scan(const char* first, const char* last);
+
+		//a value has started and is not closed yet
+		bool open()const;
+
+		//a bare top level literal (number, true, false, null) only ends at a delimiter
+		//or at the end of input
+		bool pending_literal()const;
+
+		void reset();
+
+	private:
+		int depth_;
+		bool in_string_;
+		bool escaped_;
+		bool in_literal_;
+		bool open_;
+	};
+
+	//a record that JSON::value rejected, values holds the records completed before it in the same feed
+	struct stream_error :public std::exception
+	{
+		stream_error(fcl::list<Value> vs) :std::exception("error: malformed JSON record."), values(std::move(vs)) {}
+
+		fcl::list<Value> values;
+	};
+
+	//resumable parser over chunked input
+	struct reader
+	{
+		reader();
+
+		//append a chunk and return every top level value it completed
+		//throws stream_error on a malformed record, the input after it is kept for the next call
+		fcl::list<Value> feed(const char* data, size_t size);
+
+		fcl::list<Value> feed(const std::string& chunk);
+
+		//end of input, flushes a trailing literal and rejects an unfinished value
+		fcl::list<Value> finish();
+
+		//bytes held for the record that is still open
+		size_t buffered()const;
+
+	private:
+		std::string buffer_;
+		size_t scanned_;
+		scanner scanner_;
+
+		//false when [first, last) is not exactly one value
+		bool emit(const char* first, const char* last, fcl::list<Value>& out);
+	};
+}
+
+#endif
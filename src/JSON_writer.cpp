@@ -0,0 +1,358 @@
+/*
+* JSON_writer.cpp
+* implenmentation and test stub for JSON_writer.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "JSON_writer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+using namespace JSON;
+
+namespace
+{
+	//VS2017 15.9 has the shortest floating to_chars without defining the feature macro
+#if defined(__cpp_lib_to_chars) || (defined(_MSC_VER) && _MSC_VER >= 1916 && _HAS_CXX17)
+#define JSON_WRITER_TO_CHARS
+#endif
+
+#ifndef JSON_WRITER_TO_CHARS
+	//%g follows LC_NUMERIC, whatever it puts between the digits is the decimal point
+	int normalize_point(char* buffer, int n)
+	{
+		int w = 0;
+		bool point = false;
+		for (int r = 0; r < n; ++r)
+		{
+			char c = buffer[r];
+			if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == 'e' || c == 'E')
+			{
+				buffer[w++] = c;
+				point = false;
+			}
+			else if (!point)
+			{
+				buffer[w++] = '.';
+				point = true;
+			}
+		}
+		return w;
+	}
+#endif
+
+	void append_double(double d, std::string& out)
+	{
+		char buffer[32];
+#ifdef JSON_WRITER_TO_CHARS
+		auto r = std::to_chars(buffer, buffer + sizeof(buffer), d);
+		out.append(buffer, r.ptr);
+#else
+		//the fewest significant digits that read back to d, read with the locale-free JSON scanner
+		int n = 0;
+		for (int precision = 15; precision <= 17; ++precision)
+		{
+			n = normalize_point(buffer, std::snprintf(buffer, sizeof(buffer), "%.*g", precision, d));
+			Number back;
+			scan_number(buffer, buffer + n, back);
+			if (back.value == d) break;
+		}
+		out.append(buffer, n);
+#endif
+	}
+
+	const char hex_digits[] = "0123456789abcdef";
+
+	void write_value(writer& w, const Value& value)
+	{
+		using traits = fcl::variant_traits<VD>;
+		const VD& v = value.value;
+		if (traits::is_of<String>(v)) w.string(traits::get<String>(v));
+		else if (traits::is_of<Number>(v)) w.number(traits::get<Number>(v));
+		else if (traits::is_of<Object>(v))
+		{
+			w.start_object();
+			for (const auto& m : traits::get<Object>(v).members())
+			{
+				w.key(m.first);
+				write_value(w, m.second);
+			}
+			w.end_object();
+		}
+		else if (traits::is_of<Array>(v))
+		{
+			w.start_array();
+			for (const auto& item : traits::get<Array>(v).value) write_value(w, item);
+			w.end_array();
+		}
+		else if (traits::is_of<True>(v)) w.boolean(true);
+		else if (traits::is_of<False>(v)) w.boolean(false);
+		else w.null();
+	}
+}
+
+JSON::writer::writer(style s) :buffer_(), out_(nullptr), style_(s), depth_(0), first_(true), after_key_(false), written_(false) {}
+
+JSON::writer::writer(std::ostream& out, style s) :writer(s) { out_ = &out; }
+
+JSON::writer::~writer() { if (out_ != nullptr) flush(); }
+
+void JSON::writer::write(const Value& value) { write_value(*this, value); }
+
+void JSON::writer::write(const node& value)
+{
+	switch (value.type)
+	{
+	case kind::null: null(); break;
+	case kind::boolean: boolean(value.flag); break;
+	case kind::number: number(value.number); break;
+	case kind::string: string(value.chars, value.count); break;
+	case kind::array:
+		start_array();
+		for (size_t i = 0; i < value.count; ++i) write(value.items[i]);
+		end_array();
+		break;
+	case kind::object:
+		start_object();
+		for (size_t i = 0; i < value.count; ++i)
+		{
+			key(value.members[i].key, value.members[i].key_size);
+			write(value.members[i].value);
+		}
+		end_object();
+	}
+}
+
+void JSON::writer::separate()
+{
+	if (after_key_)
+	{
+		after_key_ = false;
+		return;
+	}
+	if (depth_ == 0)
+	{
+		if (written_) buffer_ += '\n';
+		written_ = true;
+		return;
+	}
+	if (!first_) buffer_ += ',';
+	first_ = false;
+	indent();
+}
+
+void JSON::writer::indent()
+{
+	if (style_ != pretty) return;
+	buffer_ += '\n';
+	buffer_.append(depth_ * 2, ' ');
+}
+
+void JSON::writer::chunk() { if (out_ != nullptr && buffer_.size() >= chunk_size) flush(); }
+
+void JSON::writer::quote(const char* data, size_t size)
+{
+	const char* p = data;
+	const char* last = data + size;
+	buffer_ += '\"';
+	while (true)
+	{
+		const char* stop = find_special(p, last);
+		buffer_.append(p, stop);
+		if (stop == last) break;
+		switch (*stop)
+		{
+		case '\"': buffer_ += "\\\""; break;
+		case '\\': buffer_ += "\\\\"; break;
+		case '\b': buffer_ += "\\b"; break;
+		case '\f': buffer_ += "\\f"; break;
+		case '\n': buffer_ += "\\n"; break;
+		case '\r': buffer_ += "\\r"; break;
+		case '\t': buffer_ += "\\t"; break;
+		default:
+			buffer_ += "\\u00";
+			buffer_ += hex_digits[(*stop >> 4) & 0xF];
+			buffer_ += hex_digits[*stop & 0xF];
+		}
+		p = stop + 1;
+	}
+	buffer_ += '\"';
+}
+
+void JSON::writer::null()
+{
+	separate();
+	buffer_ += "null";
+	chunk();
+}
+
+void JSON::writer::boolean(bool value)
+{
+	separate();
+	buffer_ += value ? "true" : "false";
+	chunk();
+}
+
+void JSON::writer::number(const Number& value)
+{
+	//the integer only stands in for value when it is exactly the same number; -0 keeps its sign through the double
+	bool exact = value.integral && static_cast<double>(value.integer) == value.value && !(value.integer == 0 && std::signbit(value.value));
+	if (!exact) return number(value.value);
+	separate();
+	buffer_ += std::to_string(value.integer);
+	chunk();
+}
+
+void JSON::writer::number(double value)
+{
+	separate();
+	if (std::isfinite(value)) append_double(value, buffer_);
+	else buffer_ += "null";
+	chunk();
+}
+
+void JSON::writer::string(const String& value) { string(value.data(), value.size()); }
+
+void JSON::writer::string(const char* data, size_t size)
+{
+	separate();
+	quote(data, size);
+	chunk();
+}
+
+void JSON::writer::key(const String& value) { key(value.data(), value.size()); }
+
+void JSON::writer::key(const char* data, size_t size)
+{
+	separate();
+	quote(data, size);
+	buffer_ += style_ == pretty ? ": " : ":";
+	after_key_ = true;
+}
+
+void JSON::writer::start_object()
+{
+	separate();
+	buffer_ += '{';
+	++depth_;
+	first_ = true;
+}
+
+void JSON::writer::end_object()
+{
+	--depth_;
+	if (!first_) indent();
+	buffer_ += '}';
+	first_ = false;
+	chunk();
+}
+
+void JSON::writer::start_array()
+{
+	separate();
+	buffer_ += '[';
+	++depth_;
+	first_ = true;
+}
+
+void JSON::writer::end_array()
+{
+	--depth_;
+	if (!first_) indent();
+	buffer_ += ']';
+	first_ = false;
+	chunk();
+}
+
+const std::string& JSON::writer::str()const { return buffer_; }
+
+void JSON::writer::flush()
+{
+	if (out_ != nullptr && !buffer_.empty()) out_->write(buffer_.data(), buffer_.size());
+	buffer_.clear();
+}
+
+void JSON::writer::clear()
+{
+	buffer_.clear();
+	depth_ = 0;
+	first_ = true;
+	after_key_ = false;
+	written_ = false;
+}
+
+std::string JSON::serialize(const Value& value, writer::style s)
+{
+	writer w(s);
+	w.write(value);
+	return w.str();
+}
+
+#ifdef JSON_WRITER_CPP
+
+#include <clocale>
+#include <iostream>
+
+using namespace fcl;
+
+int main()
+{
+	std::string text = "{\"name\":\"Jo\\\"hn\\n\", \"age\":30, \"pi\":3.141592653589793, \"tenth\":0.1, \"big\":1e300, \"cars\":[\"Ford\", {\"model\":\"Fiat\", \"new\":false}, null], \"empty\":{}, \"none\":[]}";
+	Value v = fromJust(JSON::value(text)).first;
+
+	std::string compact = serialize(v);
+	std::cout << "compact: " << compact << std::endl;
+	std::cout << "pretty: " << serialize(v, writer::pretty) << std::endl;
+
+	//the output reads back to the same text
+	Value back = fromJust(JSON::value(compact)).first;
+	std::cout << "round trip: " << (serialize(back) == compact) << std::endl;
+
+	writer events_out;
+	events("[1, \"two\", {\"three\": [3.0]}]", events_out);
+	events(" true ", events_out);
+	std::cout << "from events: " << events_out.str() << std::endl;
+
+	document doc(text);
+	writer doc_out;
+	doc_out.write(doc.root());
+	std::cout << "from document: " << doc_out.str() << std::endl;
+
+	std::cout << "to stream: ";
+	{
+		writer w(std::cout);
+		w.write(fromJust(JSON::value("[\"\\u0001\\u00e9\", -0.0, -0, 5e-324]")).first);
+	}
+	std::cout << std::endl;
+
+	//a hand built Number whose integer does not match its value goes out as the value
+	writer mismatch;
+	mismatch.start_array();
+	mismatch.number(Number{ -0.0, true, 0 });
+	mismatch.number(Number{ 2.5, true, 2 });
+	mismatch.number(Number{ 7.0, true, 7 });
+	mismatch.end_array();
+	std::cout << "exact integers only: " << mismatch.str() << std::endl;
+
+	//a program that switches LC_NUMERIC to a comma locale still gets JSON numbers
+	Value numbers = fromJust(JSON::value("[1.5, -0.25, 3.141592653589793, 6.02214076e23, 5e-324, [0.1, {\"x\": 2.5e-7}]]")).first;
+	std::string compact_c = serialize(numbers);
+	std::string pretty_c = serialize(numbers, writer::pretty);
+	for (const char* name : { "de-DE", "de_DE.UTF-8", "de_DE.utf8", "de_DE", "German" })
+		if (std::setlocale(LC_ALL, name) != nullptr) break;
+	std::string compact_l = serialize(numbers);
+	std::string pretty_l = serialize(numbers, writer::pretty);
+	bool same = compact_l == compact_c && pretty_l == pretty_c;
+	bool read_back = serialize(fromJust(JSON::value(compact_l)).first) == compact_c && serialize(fromJust(JSON::value(pretty_l)).first) == compact_c;
+	std::setlocale(LC_ALL, "C");
+	std::cout << "under a comma locale: same text " << same << ", round trip " << read_back << std::endl;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+*   JSON_writer.h:
+*   Serializes JSON values into a single growable buffer
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	writer appends JSON text to one std::string, in compact or pretty style
+*	given a stream, the buffer is written out in chunks of about chunk_size bytes
+*	strings are escaped a run at a time, JSON::find_special locates the bytes to escape
+*	integral numbers are written exactly, others in the shortest form that reads back
+*	to the same double, non finite numbers become null
+*	writer is a JSON::handler, so JSON::events can be piped into it without a tree
+*	successive top level values are separated by a newline
+*	Show<JSON::Value> stays the debugging display, writer produces JSON
+*
+*   Public Interface:
+*	std::string s = JSON::serialize(value);
+*	std::string p = JSON::serialize(value, JSON::writer::pretty);
+*	JSON::writer w(std::cout);
+*	w.write(value); w.write(doc.root()); w.flush();
+*	JSON::events(text, w);	//reformats text
+*
+*   Build Process:
+*   requires JSON_document.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _JSON_WRITER_
+#define _JSON_WRITER_
+
+#include "JSON_document.h"
+#include <ostream>
+
+namespace JSON
+{
+	struct writer :public handler
+	{
+		enum style { compact, pretty };
+
+		const static size_t chunk_size = 64 * 1024;
+
+		explicit writer(style s = compact);
+
+		//write to out whenever the buffer reaches chunk_size
+		explicit writer(std::ostream& out, style s = compact);
+
+		~writer();
+
+		void write(const Value& value);
+
+		void write(const node& value);
+
+		void null() override;
+		void boolean(bool value) override;
+		void number(const Number& value) override;
+		void number(double value);
+		void string(const String& value) override;
+		void string(const char* data, size_t size);
+		void key(const String& value) override;
+		void key(const char* data, size_t size);
+		void start_object() override;
+		void end_object() override;
+		void start_array() override;
+		void end_array() override;
+
+		//text not handed to the stream yet
+		const std::string& str()const;
+
+		//hand everything buffered to the stream
+		void flush();
+
+		void clear();
+
+	private:
+		std::string buffer_;
+		std::ostream* out_;
+		style style_;
+		size_t depth_;
+		bool first_;
+		bool after_key_;
+		bool written_;
+
+		void separate();
+		void indent();
+		void quote(const char* data, size_t size);
+		void chunk();
+	};
+
+	std::string serialize(const Value& value, writer::style s = writer::compact);
+}
+
+#endif
@@ -0,0 +1,33 @@
+/*
+* cursor.cpp
+* test stub for cursor.h
+* no actual implenmetaion included
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#ifdef CURSOR_CPP
+
+#include "cursor.h"
+#include <iostream>
+
+using namespace fcl;
+
+int main()
+{
+	cursor c = std::string("hello world");
+	std::cout << "length: " << c.length() << std::endl;
+	std::cout << "head: " << c.head() << std::endl;
+	std::cout << "tail: " << c.tail().str() << std::endl;
+	cursor w = c.drop(6);
+	std::cout << "drop 6: " << w.str() << " at position " << w.position() << std::endl;
+	std::cout << "take 5: " << c.take(5).str() << std::endl;
+	std::cout << "shares buffer: " << (c.owner() == w.owner()) << std::endl;
+	std::cout << "starts with hello: " << c.starts_with("hello") << std::endl;
+	std::cout << "drop past end is empty: " << c.drop(100).empty() << std::endl;
+
+	const char raw[] = "borrowed";
+	cursor v(raw, raw + 8);
+	std::cout << "view: " << v.str() << ", owned: " << (v.owner() != nullptr) << std::endl;
+}
+
+#endif
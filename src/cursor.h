@@ -0,0 +1,119 @@
+/*
+*   cursor.h:
+*   A non-owning input position for the Parser monad
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	a pair of pointers into an immutable character buffer
+*	the buffer is shared by every cursor derived from the same input
+*	and kept alive by an optional owner handle
+*	consuming input only advances a pointer, nothing is copied or reallocated
+*
+*   Public Interface:
+*	cursor c = std::string("1+2");	//takes the string into a shared buffer
+*	cursor v(ptr, ptr + n);			//views a buffer the caller keeps alive
+*	bool e = c.empty();
+*	char h = c.head();
+*	cursor t = c.tail();
+*	cursor d = c.drop(2);
+*	cursor s = c.take(2);			//same buffer, limited to 2 characters
+*	size_t p = c.position();		//offset from the start of the buffer
+*	std::string r = c.str();
+*
+*   Build Process:
+*   requires meta.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft, replaces std::string as the state of Parser
+*
+*
+*/
+
+#pragma once
+#ifndef _CURSOR_
+#define _CURSOR_
+
+#include "meta.h"
+#include <memory>
+#include <cstring>
+
+namespace fcl
+{
+	struct cursor
+	{
+		cursor() :owner_(), begin_(nullptr), pos_(nullptr), end_(nullptr) {}
+
+		cursor(std::string str)
+		{
+			auto buffer = std::make_shared<const std::string>(std::move(str));
+			begin_ = pos_ = buffer->data();
+			end_ = begin_ + buffer->size();
+			owner_ = std::move(buffer);
+		}
+
+		cursor(const char* str) :cursor(std::string(str)) {}
+
+		//view a buffer without taking ownership, owner (if any) is kept alive by every copy
+		cursor(const char* first, const char* last, std::shared_ptr<const void> owner = nullptr)
+			:owner_(std::move(owner)), begin_(first), pos_(first), end_(last) {}
+
+		bool empty()const { return pos_ == end_; }
+
+		size_t length()const { return end_ - pos_; }
+
+		char head()const { return *pos_; }
+
+		cursor tail()const { return drop(1); }
+
+		cursor drop(size_t n)const
+		{
+			cursor next(*this);
+			next.pos_ += n < length() ? n : length();
+			return next;
+		}
+
+		cursor take(size_t n)const
+		{
+			cursor prefix(*this);
+			prefix.end_ = pos_ + (n < length() ? n : length());
+			return prefix;
+		}
+
+		bool starts_with(const std::string& str)const
+		{
+			return str.size() <= length() && std::memcmp(pos_, str.data(), str.size()) == 0;
+		}
+
+		const char* data()const { return pos_; }
+
+		const char* end()const { return end_; }
+
+		size_t position()const { return pos_ - begin_; }
+
+		const std::shared_ptr<const void>& owner()const { return owner_; }
+
+		std::string str()const { return std::string(pos_, end_); }
+
+	private:
+		std::shared_ptr<const void> owner_;
+		const char* begin_;
+		const char* pos_;
+		const char* end_;
+	};
+}
+
+namespace util
+{
+	template<>
+	struct type<fcl::cursor> { static std::string infer() { return "String"; } };
+}
+
+#endif
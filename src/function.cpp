@@ -2,6 +2,7 @@
 * function.cpp
 * testing file for function.h
 * no actual implenmetaion included
+* define FUNCTION_BENCH instead of FUNCTION_CPP for the call overhead benchmark
 * Yunsheng Guo yguo125@syr.edu
 */
 
@@ -95,6 +96,17 @@ int main()
 
 	std::cout << std::endl << "f construct assign : " << tf14(4, 3, 2, 1) << std::endl << std::endl;
 
+	std::cout << std::endl << "function small buffer start" << std::endl << std::endl;
+
+	function<int, int, int> am = tf1 << 4 << 3;
+	function<int, int, int> am1(am);
+	function<int, int, int> am2(std::move(am1));
+	am1 = am2;
+	am = std::move(am2);
+	std::cout << "inline copy, move and assign: " << am(2, 1) << " " << am1(2, 1) << std::endl;
+
+	std::cout << std::endl << "function small buffer end" << std::endl << std::endl;
+
 	function<int, int, int, int, int>* fptr = new function<int, int, int, int, int>(tf14);
 
 	delete fptr;
@@ -110,6 +122,101 @@ int main()
 	function<na, int> tf16(increment);
 
 	tf16 << 5;
+
+	std::cout << std::endl << "function capture start" << std::endl << std::endl;
+
+	int offset = 10;
+	function<int, int> add_offset = [offset](int x) { return x + offset; };
+	std::string label = "captured string";
+	function<int, int, int> labelled = [label](int x, int y) { std::cout << label << ": "; return x * y; };
+	function<int, int, int> labelled1(labelled);
+	std::cout << "small capture: " << add_offset(5) << std::endl;
+	std::cout << (labelled << 6 << 7) << std::endl;
+	std::cout << (7 >>= labelled1 << 3) << std::endl;
+
+	std::cout << std::endl << "function capture end" << std::endl << std::endl;
+
+	std::cout << std::endl << "function reference start" << std::endl << std::endl;
+
+	function_ref<int, int, int, int, int> rf1 = tf1;
+	function_ref<int, int, int, int, int> rf2 = test_function2;
+	auto minus_offset = [offset](int x) { return x - offset; };
+	function_ref<int, int> rf3 = minus_offset;
+	std::cout << "calls: " << rf1(4, 3, 2, 1) << " " << rf2(4, 3, 2, 1) << " " << rf3(15) << std::endl;
+	function<int, int, int, int> owned = rf1 << 4;
+	std::cout << "applied: " << (owned << 3 << 2 << 1) << " " << (1 >>= rf2 << 4 << 3 << 2) << " " << (rf3 << 20) << std::endl;
+	//a function made from a reference owns a copy of the target
+	function<int, int> kept(rf3);
+	std::cout << "owned copy: " << kept(15) << " " << rf3.own()(15) << std::endl;
+
+	std::cout << std::endl << "function reference end" << std::endl << std::endl;
+}
+
+#endif
+#ifdef FUNCTION_BENCH
+
+#include "function.h"
+#include <chrono>
+#include <iostream>
+
+using namespace fcl;
+
+int add_3(int a, int b, int c) { return a + b + c; }
+
+int length_plus(std::string s, int i) { return static_cast<int>(s.size()) + i; }
+
+int length_8(std::string a, std::string b, std::string c, std::string d, std::string e, std::string f, std::string g, int i)
+{
+	return static_cast<int>(a.size() + b.size() + c.size() + d.size() + e.size() + f.size() + g.size()) + i;
+}
+
+//calls per second of f(i, i, i) for n rounds
+template<typename f>
+double calls_per_second(const f& func, int n, int& sink)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < n; ++i) sink += func(i);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return n / elapsed.count();
+}
+
+void report(const char* label, double rate, double baseline)
+{
+	std::cout << label << ": " << rate / 1e6 << " M calls/s (" << baseline / rate << "x raw pointer time)" << std::endl;
+}
+
+int main()
+{
+	const int n = 20000000;
+	int sink = 0;
+
+	//volatile keeps the targets opaque, nothing is inlined or devirtualized away
+	int(*volatile raw)(int, int, int) = add_3;
+	function<int, int, int, int> full = add_3;
+	function<int, int> applied = full << 1 << 2;
+	int offset = 3;
+	function<int, int> captured = [offset](int a) { return a + offset; };
+	function<int, int, int, int>* volatile full_ptr = &full;
+	function<int, int>* volatile applied_ptr = &applied;
+	function<int, int>* volatile captured_ptr = &captured;
+	function<int, int> bound_string = function<int, std::string, int>(length_plus) << std::string(64, 'x');
+	function<int, int>* volatile bound_string_ptr = &bound_string;
+
+	double baseline = calls_per_second([&](int i) { return raw(i, i, i); }, n, sink);
+	report("raw function pointer", baseline, baseline);
+	report("function<int,int,int,int>", calls_per_second([&](int i) { return (*full_ptr)(i, i, i); }, n, sink), baseline);
+	report("function << 1 << 2", calls_per_second([&](int i) { return (*applied_ptr)(i); }, n, sink), baseline);
+	report("function with capture", calls_per_second([&](int i) { return (*captured_ptr)(i); }, n, sink), baseline);
+	report("function with a bound std::string", calls_per_second([&](int i) { return (*bound_string_ptr)(i); }, n, sink), baseline);
+	//curried application, every << on the temporary rebinds all earlier arguments unless _FLAT_ARGUMENTS_
+	function<int, std::string, std::string, std::string, std::string, std::string, std::string, std::string, int> wide = length_8;
+	const std::string word(32, 'w');
+	auto start = std::chrono::steady_clock::now();
+	const int chains = 200000;
+	for (int i = 0; i < chains; ++i) sink += (wide << word << word << word << word << word << word << word)(i);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "7 chained applications: " << chains / elapsed.count() / 1e6 << " M chains/s" << std::endl;
+	std::cout << "checksum: " << sink << std::endl;
 }
 
-#endif
\ No newline at end of file
+#endif
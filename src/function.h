@@ -13,7 +13,7 @@
 *   Package Operations:
 *	takes a function pointer in the form of r function(a first, as...rest)
 *	or a type which can be converted as such
-*	does not take lambda with capture
+*	any other callable (lambda with capture, functor) is stored in the container as it is
 *	call with operator()
 *	partial or fullly apply with operator<<
 *	monadic partial apply (reversed order) with operator>>=
@@ -22,6 +22,7 @@
 *	function<int,int> k = unary_function;
 *	function<int,int> l(unary_function);
 *	function<int,int,int,int,int> m(sum_4);
+*	function<int,int> n = [offset](int x) { return x + offset; };
 *	l = k;
 *	k = std::move(l);
 *	int r = k(1);
@@ -32,6 +33,9 @@
 *	int r4 = 4 >>= 3 >>= 2 >>= 1 >>= m;
 *   int r5 = 4 >>= 3 >>= am;
 *	int r6 = am.apply_r(3).apply_r(4); //is not encouraged
+*	function_ref<int,int,int> mr = am;	//am has to outlive mr
+*	function<int,int> bm = mr << 3;		//owns a copy of am
+*	function<int,int,int> om(mr);		//explicit, owns a copy of am as well
 *
 *   Build Process:
 *   requires meta.h
@@ -43,6 +47,16 @@
 *   refactor by type erasure
 *	August 25
 *	final review for publish
+*	October 18
+*	small containers (a function pointer plus trivially copyable bound arguments)
+*	are kept in an inline buffer of function, the heap is only used for large captures
+*	closure_container stores any callable, func_container is the function pointer case
+*	calls go through a trampoline pointer kept next to the container instead of
+*	the virtual invoke, arguments are passed as they are and bound ones from where they live
+*	function_ref refers to a callable without owning or copying it
+*	heap containers are reference counted, copying a function no longer clones them
+*	with _FLAT_ARGUMENTS_ bound arguments live in one block allocated at the first application,
+*	applying to an rvalue function that owns its block alone fills the next slot in place
 *
 *
 */
@@ -52,6 +66,10 @@
 #define _FUNCTION_
 
 #include "meta.h"
+#include <new>
+#include <cstddef>
+#include <atomic>
+#include <memory>
 
 #ifdef _COPY_ELISION_
 #include "shared_tuple.h"
@@ -118,9 +136,68 @@ namespace details
 	template<size_t front, size_t back, typename ...as>
 	using inferred_para_list = typename TMP::take<typename TMP::drop<TMP::list<as...>, front>::type, TMP::length<TMP::list<as...>>::value - front - back>::type;
 
+	//plain function pointer that calls a container through its base self
+	template<typename r, typename self, typename pack_of_a>
+	struct call_signature;
+
+	template<typename r, typename self, typename ...as>
+	struct call_signature<r, self, TMP::Pack<as...>> { using type = r(*)(const self*, as...); };
+
+	//the trampoline of a container, the arguments go by value straight to its call
+	template<typename container, typename r, typename pack_of_a>
+	struct dispatch;
+
+	template<typename container, typename r, typename ...as>
+	struct dispatch<container, r, TMP::Pack<as...>>
+	{
+		static r call(const typename container::applicable* self, as...args)
+		{
+			return static_cast<const container*>(self)->call(std::forward<as>(args)...);
+		}
+	};
+
+	//reference count of a heap container, shared by every function holding it
+	//a copied container starts a count of its own
+	//define _SINGLE_THREADED_ for plain counters when no function crosses threads
+	struct refcount
+	{
+		refcount() :count_(1) {}
+
+		refcount(const refcount&) :count_(1) {}
+
+		refcount& operator=(const refcount&) { return *this; }
+
+#ifdef _SINGLE_THREADED_
+		void retain()const { ++count_; }
+
+		//true when the last reference is gone
+		bool release()const { return --count_ == 0; }
+
+		bool unique()const { return count_ == 1; }
+
+	private:
+		mutable size_t count_;
+#else
+		//a container is immutable once built and reaches other threads through whatever hands them the function,
+		//so the count only has to order the last use of each holder before the delete:
+		//retain can be relaxed since the caller already holds a reference and the count cannot reach zero meanwhile,
+		//release publishes this holder's reads and its acquire half lets the last holder see everyone else's,
+		//unique acquires for the same reason before a sole holder writes into the container
+		void retain()const { count_.fetch_add(1, std::memory_order_relaxed); }
+
+		//true when the last reference is gone
+		bool release()const { return count_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+		bool unique()const { return count_.load(std::memory_order_acquire) == 1; }
+
+	private:
+		mutable std::atomic<size_t> count_;
+#endif
+	};
+
 	//functor operator overload and invoke interface
 	template<typename r, typename list_of_a>
-	struct applicable
+	struct applicable :public refcount
 	{
 		using is_unary = std::bool_constant<TMP::length<list_of_a>::value == 1>;
 
@@ -134,17 +211,90 @@ namespace details
 
 		using para_tuple = typename TMP::to_tuple<list_of_a>::type;
 
+		using para_pack = TMP::to_pack_t<list_of_a>;
+
+		using call_type = typename call_signature<r, applicable, para_pack>::type;
+
 		virtual r invoke(para_tuple&& tuple)const = 0;
 
-		virtual front_applied_type push_front(front&& arg)const = 0;
+		//the non-virtual entry point for calls, looked up once when a storage takes the container
+		virtual call_type trampoline()const = 0;
+
+		//buffer is where the result is built if it is small enough, nullptr forces the heap
+		virtual front_applied_type push_front(front&& arg, void* buffer = nullptr)const = 0;
 
-		virtual back_applied_type push_back(back&& arg)const = 0;
+		virtual back_applied_type push_back(back&& arg, void* buffer = nullptr)const = 0;
 
-		virtual applicable* new_ptr()const = 0;
+		//push_front by the only owner of this container, which is destroyed right after
+		//a container may move its bound arguments into the result instead of copying them
+		virtual front_applied_type consume_front(front&& arg, void* buffer = nullptr) { return push_front(std::forward<front>(arg), buffer); }
+
+		virtual back_applied_type consume_back(back&& arg, void* buffer = nullptr) { return push_back(std::forward<back>(arg), buffer); }
+
+		virtual applicable* new_ptr(void* buffer = nullptr)const = 0;
+
+		//true if this container is small enough to live in a function's inline buffer
+		virtual bool is_small()const = 0;
 
 		virtual ~applicable() {}
 	};
 
+	//size of the inline buffer every function keeps for small containers
+	//enough for the vtable, the reference count, a function pointer and a few bound arguments
+	constexpr size_t small_buffer_size = 7 * sizeof(void*);
+
+	struct small_buffer { alignas(std::max_align_t) unsigned char data[small_buffer_size]; };
+
+	//true if every type of the list can be copied as raw bytes
+	template<typename list_of_a>
+	struct all_trivial;
+
+	template<>
+	struct all_trivial<TMP::Nil> :public std::true_type {};
+
+	template<typename a, typename b>
+	struct all_trivial<TMP::Cons<a, b>> :public std::bool_constant<std::is_trivially_copyable<a>::value && all_trivial<b>::value> {};
+
+	//a container is small if it fits the buffer and copying it never touches the heap
+	template<typename container>
+	struct is_small :public std::bool_constant<
+		sizeof(container) <= small_buffer_size &&
+		alignof(container) <= alignof(small_buffer) &&
+		std::is_trivially_copyable<typename container::target>::value &&
+		all_trivial<typename container::bound_list>::value
+	> {};
+
+	//f can be called with as... and its result converts to r
+	template<typename f, typename r, typename ...as>
+	struct is_callable
+	{
+	private:
+		template<typename g, typename = std::enable_if_t<std::is_convertible<decltype(std::declval<const g&>()(std::declval<as>()...)), r>::value>>
+		static std::true_type test(int);
+
+		template<typename g>
+		static std::false_type test(...);
+
+	public:
+		enum { value = decltype(test<f>(0))::value };
+	};
+
+	//a function_ref is callable too, but storing one would only keep the reference
+	template<typename f>
+	struct is_function_ref :std::false_type {};
+
+	template<typename r, typename ...as>
+	struct is_function_ref<fcl::function_ref<r, as...>> :std::true_type {};
+
+	//build a container inside buffer if it is small, otherwise on the heap
+	template<typename container, typename ...args>
+	container* emplace(void* buffer, args&&...arg)
+	{
+		if (buffer != nullptr && is_small<container>::value)
+			return new (buffer) container(std::forward<args>(arg)...);
+		return new container(std::forward<args>(arg)...);
+	}
+
 #ifdef _COPY_ELISION_
 	template<typename a>
 	struct to_shared_tuple;
@@ -157,12 +307,22 @@ namespace details
 #endif
 
 	//function concept concrete instance for type erasure
-	template<size_t fi, size_t bi, typename r, typename ...as>
-	struct func_container;
+	//F is the target, a function pointer or any callable taking as... (a lambda with capture included)
+	template<typename F, size_t fi, size_t bi, typename r, typename ...as>
+	struct closure_container;
+
+#ifdef _FLAT_ARGUMENTS_
+	//container whose bound arguments share one block sized for every parameter
+	template<typename F, size_t fi, size_t bi, typename r, typename ...as>
+	struct flat_container;
+
+	template<typename ...as>
+	struct argument_block;
+#endif
 
 	//general implementation
-	template<size_t fi, size_t bi, typename r, typename ...as>
-	struct func_container :public details::applicable<r, details::inferred_para_list<fi, bi, as...>>
+	template<typename F, size_t fi, size_t bi, typename r, typename ...as>
+	struct closure_container :public details::applicable<r, details::inferred_para_list<fi, bi, as...>>
 	{
 		using applicable = details::applicable<r, details::inferred_para_list<fi, bi, as...>>;
 
@@ -170,6 +330,10 @@ namespace details
 
 		enum { length = sizeof...(as) };
 
+		using bound_list = TMP::concat_t<TMP::take_t<para_list, fi>, TMP::drop_t<para_list, length - bi>>;
+
+		using target = F;
+
 #ifdef _COPY_ELISION_
 		using front_tuple = to_shared_tuple_t<TMP::to_tuple_t<TMP::take_t<para_list, fi>>>;
 
@@ -186,47 +350,55 @@ namespace details
 
 		using back = typename applicable::back;
 
-		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<fi + 1, bi, r, as...>*>::type;
+		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, fi + 1, bi, r, as...>*>::type;
 
-		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<fi, bi + 1, r, as...>*>::type;
+		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, fi, bi + 1, r, as...>*>::type;
 
-		func_container() = delete;
+		closure_container() = delete;
 
-		template<typename T, typename = std::enable_if_t<std::is_convertible<T, details::func_ptr<r, as...>>::value>>
-		func_container(T p, front_tuple&& ft, back_tuple&& bt) :ptr_(p), ft_(std::forward<front_tuple>(ft)), bt_(std::forward<back_tuple>(bt)) {}
+		template<typename T, typename = std::enable_if_t<std::is_convertible<T, F>::value>>
+		closure_container(T p, front_tuple&& ft, back_tuple&& bt) :ptr_(std::move(p)), ft_(std::forward<front_tuple>(ft)), bt_(std::forward<back_tuple>(bt)) {}
 
-		func_container(const func_container& other) :ptr_(other.ptr_), ft_(other.ft_), bt_(other.bt_) {}
+		closure_container(const closure_container& other) :ptr_(other.ptr_), ft_(other.ft_), bt_(other.bt_) {}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		front_applied_type front_apply(front&& arg) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
+		front_applied_type front_apply(front&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		front_applied_type front_apply(front&& arg) const
+		front_applied_type front_apply(front&& arg, void* buffer) const
 		{
 			auto bt(bt_);
 #ifdef _COPY_ELISION_
-			return new func_container<fi + 1, bi, r, as...>(ptr_, std::move(ft_.push_back(std::forward<front>(arg))), std::move(bt));
+			return emplace<closure_container<F, fi + 1, bi, r, as...>>(buffer, ptr_, std::move(ft_.push_back(std::forward<front>(arg))), std::move(bt));
 #else
 			auto ft(ft_);
-			return new func_container<fi + 1, bi, r, as...>(ptr_, std::tuple_cat(std::move(ft), std::make_tuple(arg)), std::move(bt));
+			return emplace<closure_container<F, fi + 1, bi, r, as...>>(buffer, ptr_, std::tuple_cat(std::move(ft), std::make_tuple(arg)), std::move(bt));
 #endif
 		}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		back_applied_type back_apply(back&& arg) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
+		back_applied_type back_apply(back&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		back_applied_type back_apply(back&& arg) const
+		back_applied_type back_apply(back&& arg, void* buffer) const
 		{
 			auto ft(ft_);
 #ifdef _COPY_ELISION_
-			return new func_container<fi, bi + 1, r, as...>(ptr_, std::move(ft), std::move(bt_.push_front(std::forward<back>(arg))));
+			return emplace<closure_container<F, fi, bi + 1, r, as...>>(buffer, ptr_, std::move(ft), std::move(bt_.push_front(std::forward<back>(arg))));
 #else
 			auto bt(bt_);
-			return new func_container<fi, bi + 1, r, as...>(ptr_, std::move(ft), std::tuple_cat(std::make_tuple(arg), std::move(bt)));
+			return emplace<closure_container<F, fi, bi + 1, r, as...>>(buffer, ptr_, std::move(ft), std::tuple_cat(std::make_tuple(arg), std::move(bt)));
 #endif
 		}
 
+#ifdef _COPY_ELISION_
+		template<typename ...ps>
+		r call(ps&&...args)const { return std::apply(ptr_, std::tuple_cat(ft_.to_tuple(), std::forward_as_tuple(std::forward<ps>(args)...), bt_.to_tuple())); }
+#else
+		template<typename ...ps>
+		r call(ps&&...args)const { return call_bound(std::make_index_sequence<fi>(), std::make_index_sequence<bi>(), std::forward<ps>(args)...); }
+#endif
+
 		r invoke(para_tuple&& t)const override
 		{
 #ifdef _COPY_ELISION_
@@ -238,29 +410,40 @@ namespace details
 #endif
 		}
 
-		typename applicable::front_applied_type push_front(front&& arg)const override
+		typename applicable::front_applied_type push_front(front&& arg, void* buffer = nullptr)const override
 		{
-			return front_apply(std::forward<front>(arg));
+			return front_apply(std::forward<front>(arg), buffer);
 		}
 
-		typename applicable::back_applied_type push_back(back&& arg)const override
+		typename applicable::back_applied_type push_back(back&& arg, void* buffer = nullptr)const override
 		{
-			return back_apply(std::forward<back>(arg));
+			return back_apply(std::forward<back>(arg), buffer);
 		}
 
-		applicable* new_ptr()const override { return new func_container(*this); }
+		typename applicable::call_type trampoline()const override { return &dispatch<closure_container, r, typename applicable::para_pack>::call; }
+
+		applicable* new_ptr(void* buffer = nullptr)const override { return emplace<closure_container>(buffer, *this); }
+
+		bool is_small()const override { return details::is_small<closure_container>::value; }
 
-		virtual ~func_container() override {}
+		virtual ~closure_container() override {}
 
 	private:
-		details::func_ptr<r, as...> ptr_;
+		F ptr_;
 		front_tuple ft_;
 		back_tuple bt_;
+
+		//bound arguments are passed from where they are stored, nothing is concatenated
+		template<size_t ...I, size_t ...J, typename ...ps>
+		r call_bound(std::index_sequence<I...>, std::index_sequence<J...>, ps&&...args)const
+		{
+			return ptr_(std::get<I>(ft_)..., std::forward<ps>(args)..., std::get<J>(bt_)...);
+		}
 	};
 
 	//bedrock implementation with a target function
-	template<typename r, typename ...as>
-	struct func_container<0, 0, r, as...> :public details::applicable<r, TMP::list<as...>>
+	template<typename F, typename r, typename ...as>
+	struct closure_container<F, 0, 0, r, as...> :public details::applicable<r, TMP::list<as...>>
 	{
 		using applicable = details::applicable<r, TMP::list<as...>>;
 
@@ -268,75 +451,100 @@ namespace details
 
 		enum { length = sizeof...(as) };
 
+		using bound_list = TMP::Nil;
+
+		using target = F;
+
 		using para_tuple = typename applicable::para_tuple;
 
 		using front = typename applicable::front;
 
 		using back = typename applicable::back;
 
-		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<1, 0, r, as...>*>::type;
+#ifdef _FLAT_ARGUMENTS_
+		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, flat_container<F, 1, 0, r, as...>*>::type;
 
-		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<0, 1, r, as...>*>::type;
+		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, flat_container<F, 0, 1, r, as...>*>::type;
+#else
+		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, 1, 0, r, as...>*>::type;
 
-		func_container() = delete;
+		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, 0, 1, r, as...>*>::type;
+#endif
 
-		template<typename T, typename = std::enable_if_t<std::is_convertible<T, details::func_ptr<r, as...>>::value>>
-		func_container(T p) :ptr_(p) {}
+		closure_container() = delete;
 
-		func_container(const func_container& other) :ptr_(other.ptr_) {}
+		template<typename T, typename = std::enable_if_t<std::is_convertible<T, F>::value>>
+		closure_container(T p) :ptr_(std::move(p)) {}
+
+		closure_container(const closure_container& other) :ptr_(other.ptr_) {}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		front_applied_type front_apply(front&& arg) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
+		front_applied_type front_apply(front&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		front_applied_type front_apply(front&& arg) const
+		front_applied_type front_apply(front&& arg, void* buffer) const
 		{
-#ifdef _COPY_ELISION_
-			return new func_container<1, 0, r, as...>(ptr_, shared_tuple<front>(std::forward<front>(arg)));
+#if defined(_FLAT_ARGUMENTS_)
+			auto args = std::make_unique<argument_block<as...>>();
+			args->template construct<0>(std::forward<front>(arg));
+			return new flat_container<F, 1, 0, r, as...>(ptr_, std::move(args));
+#elif defined(_COPY_ELISION_)
+			return emplace<closure_container<F, 1, 0, r, as...>>(buffer, ptr_, shared_tuple<front>(std::forward<front>(arg)));
 #else
-			return new func_container<1, 0, r, as...>(ptr_, std::make_tuple(std::forward<front>(arg)));
+			return emplace<closure_container<F, 1, 0, r, as...>>(buffer, ptr_, std::make_tuple(std::forward<front>(arg)));
 #endif
 		}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		back_applied_type back_apply(back&& arg) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
+		back_applied_type back_apply(back&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		back_applied_type back_apply(back&& arg) const
+		back_applied_type back_apply(back&& arg, void* buffer) const
 		{
-#ifdef _COPY_ELISION_
-			return new func_container<0, 1, r, as...>(ptr_, shared_tuple<back>(std::forward<back>(arg)));
+#if defined(_FLAT_ARGUMENTS_)
+			auto args = std::make_unique<argument_block<as...>>();
+			args->template construct<length - 1>(std::forward<back>(arg));
+			return new flat_container<F, 0, 1, r, as...>(ptr_, std::move(args));
+#elif defined(_COPY_ELISION_)
+			return emplace<closure_container<F, 0, 1, r, as...>>(buffer, ptr_, shared_tuple<back>(std::forward<back>(arg)));
 #else
-			return new func_container<0, 1, r, as...>(ptr_, std::make_tuple(std::forward<back>(arg)));
+			return emplace<closure_container<F, 0, 1, r, as...>>(buffer, ptr_, std::make_tuple(std::forward<back>(arg)));
 #endif
 		}
 
+		template<typename ...ps>
+		r call(ps&&...args)const { return ptr_(std::forward<ps>(args)...); }
+
 		r invoke(para_tuple&& t)const override
 		{
 			return std::apply(ptr_, std::forward<para_tuple>(t));
 		}
 
-		typename applicable::front_applied_type push_front(front&& arg)const override
+		typename applicable::front_applied_type push_front(front&& arg, void* buffer = nullptr)const override
 		{
-			return front_apply(std::forward<front>(arg));
+			return front_apply(std::forward<front>(arg), buffer);
 		}
 
-		typename applicable::back_applied_type push_back(back&& arg)const override
+		typename applicable::back_applied_type push_back(back&& arg, void* buffer = nullptr)const override
 		{
-			return back_apply(std::forward<back>(arg));
+			return back_apply(std::forward<back>(arg), buffer);
 		}
 
-		applicable* new_ptr()const override { return new func_container(*this); }
+		typename applicable::call_type trampoline()const override { return &dispatch<closure_container, r, typename applicable::para_pack>::call; }
+
+		applicable* new_ptr(void* buffer = nullptr)const override { return emplace<closure_container>(buffer, *this); }
 
-		virtual ~func_container() override {}
+		bool is_small()const override { return details::is_small<closure_container>::value; }
+
+		virtual ~closure_container() override {}
 
 	private:
-		details::func_ptr<r, as...> ptr_;
+		F ptr_;
 	};
 
 	//pure forward applied implementation
-	template<size_t fi, typename r, typename ...as>
-	struct func_container<fi, 0, r, as...> :public details::applicable<r, details::inferred_para_list<fi, 0, as...>>
+	template<typename F, size_t fi, typename r, typename ...as>
+	struct closure_container<F, fi, 0, r, as...> :public details::applicable<r, details::inferred_para_list<fi, 0, as...>>
 	{
 		using applicable = details::applicable<r, details::inferred_para_list<fi, 0, as...>>;
 
@@ -344,6 +552,10 @@ namespace details
 
 		enum { length = sizeof...(as) };
 
+		using bound_list = TMP::take_t<para_list, fi>;
+
+		using target = F;
+
 #ifdef _COPY_ELISION_
 		using front_tuple = to_shared_tuple_t<TMP::to_tuple_t<TMP::take_t<para_list, fi>>>;
 #else
@@ -356,45 +568,53 @@ namespace details
 
 		using back = typename applicable::back;
 
-		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<fi + 1, 0, r, as...>*>::type;
+		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, fi + 1, 0, r, as...>*>::type;
 
-		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<fi, 1, r, as...>*>::type;
+		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, fi, 1, r, as...>*>::type;
 
-		func_container() = delete;
+		closure_container() = delete;
 
-		template<typename T, typename = std::enable_if_t<std::is_convertible<T, details::func_ptr<r, as...>>::value>>
-		func_container(T p, front_tuple&& ft) :ptr_(p), ft_(std::forward<front_tuple>(ft)) {}
+		template<typename T, typename = std::enable_if_t<std::is_convertible<T, F>::value>>
+		closure_container(T p, front_tuple&& ft) :ptr_(std::move(p)), ft_(std::forward<front_tuple>(ft)) {}
 
-		func_container(const func_container& other) :ptr_(other.ptr_), ft_(other.ft_) {}
+		closure_container(const closure_container& other) :ptr_(other.ptr_), ft_(other.ft_) {}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		front_applied_type front_apply(front&& arg) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
+		front_applied_type front_apply(front&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		front_applied_type front_apply(front&& arg) const
+		front_applied_type front_apply(front&& arg, void* buffer) const
 		{
 #ifdef _COPY_ELISION_
-			return new func_container<fi + 1, 0, r, as...>(ptr_, ft_.push_back(std::forward<front>(arg)));
+			return emplace<closure_container<F, fi + 1, 0, r, as...>>(buffer, ptr_, ft_.push_back(std::forward<front>(arg)));
 #else
 			auto ft(ft_);
-			return new func_container<fi + 1, 0, r, as...>(ptr_, std::tuple_cat(std::move(ft), std::make_tuple(std::forward<front>(arg))));
+			return emplace<closure_container<F, fi + 1, 0, r, as...>>(buffer, ptr_, std::tuple_cat(std::move(ft), std::make_tuple(std::forward<front>(arg))));
 #endif
 		}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		back_applied_type back_apply(back&& arg) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
+		back_applied_type back_apply(back&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		back_applied_type back_apply(back&& arg) const
+		back_applied_type back_apply(back&& arg, void* buffer) const
 		{
 			auto ft(ft_);
 #ifdef _COPY_ELISION_
-			return new func_container<fi, 1, r, as...>(ptr_, std::move(ft), shared_tuple<back>(std::forward<back>(arg)));
+			return emplace<closure_container<F, fi, 1, r, as...>>(buffer, ptr_, std::move(ft), shared_tuple<back>(std::forward<back>(arg)));
 #else
-			return new func_container<fi, 1, r, as...>(ptr_, std::move(ft), std::make_tuple(std::forward<back>(arg)));
+			return emplace<closure_container<F, fi, 1, r, as...>>(buffer, ptr_, std::move(ft), std::make_tuple(std::forward<back>(arg)));
 #endif
 		}
 
+#ifdef _COPY_ELISION_
+		template<typename ...ps>
+		r call(ps&&...args)const { return std::apply(ptr_, std::tuple_cat(ft_.to_tuple(), std::forward_as_tuple(std::forward<ps>(args)...))); }
+#else
+		template<typename ...ps>
+		r call(ps&&...args)const { return call_bound(std::make_index_sequence<fi>(), std::forward<ps>(args)...); }
+#endif
+
 		r invoke(para_tuple&& t)const override
 		{
 #ifdef _COPY_ELISION_
@@ -405,29 +625,36 @@ namespace details
 #endif
 		}
 
-		typename applicable::front_applied_type push_front(front&& arg)const override
+		typename applicable::front_applied_type push_front(front&& arg, void* buffer = nullptr)const override
 		{
-			return front_apply(std::forward<front>(arg));
+			return front_apply(std::forward<front>(arg), buffer);
 		}
 
-		typename applicable::back_applied_type push_back(back&& arg)const override
+		typename applicable::back_applied_type push_back(back&& arg, void* buffer = nullptr)const override
 		{
-			return back_apply(std::forward<back>(arg));
+			return back_apply(std::forward<back>(arg), buffer);
 		}
 
-		applicable* new_ptr()const override { return new func_container(*this); }
+		typename applicable::call_type trampoline()const override { return &dispatch<closure_container, r, typename applicable::para_pack>::call; }
+
+		applicable* new_ptr(void* buffer = nullptr)const override { return emplace<closure_container>(buffer, *this); }
+
+		bool is_small()const override { return details::is_small<closure_container>::value; }
 
-		virtual ~func_container() override {}
+		virtual ~closure_container() override {}
 
 	private:
-		details::func_ptr<r, as...> ptr_;
+		F ptr_;
 		front_tuple ft_;
+
+		template<size_t ...I, typename ...ps>
+		r call_bound(std::index_sequence<I...>, ps&&...args)const { return ptr_(std::get<I>(ft_)..., std::forward<ps>(args)...); }
 	};
 
 
 	//pure backward applied implementation
-	template<size_t bi, typename r, typename ...as>
-	struct func_container<0, bi, r, as...> :public details::applicable<r, details::inferred_para_list<0, bi, as...>>
+	template<typename F, size_t bi, typename r, typename ...as>
+	struct closure_container<F, 0, bi, r, as...> :public details::applicable<r, details::inferred_para_list<0, bi, as...>>
 	{
 		using applicable = details::applicable<r, details::inferred_para_list<0, bi, as...>>;
 
@@ -435,6 +662,10 @@ namespace details
 
 		enum { length = sizeof...(as) };
 
+		using bound_list = TMP::drop_t<para_list, length - bi>;
+
+		using target = F;
+
 #ifdef _COPY_ELISION_
 		using back_tuple = to_shared_tuple_t<TMP::to_tuple_t<TMP::drop_t<para_list, length - bi>>>;
 #else
@@ -447,45 +678,53 @@ namespace details
 
 		using back = typename applicable::back;
 
-		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<1, bi, r, as...>*>::type;
+		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, 1, bi, r, as...>*>::type;
 
-		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, func_container<0, bi + 1, r, as...>*>::type;
+		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, closure_container<F, 0, bi + 1, r, as...>*>::type;
 
-		func_container() = delete;
+		closure_container() = delete;
 
-		template<typename T, typename = std::enable_if_t<std::is_convertible<T, details::func_ptr<r, as...>>::value>>
-		func_container(T p, back_tuple&& bt) :ptr_(p), bt_(std::forward<back_tuple>(bt)) {}
+		template<typename T, typename = std::enable_if_t<std::is_convertible<T, F>::value>>
+		closure_container(T p, back_tuple&& bt) :ptr_(std::move(p)), bt_(std::forward<back_tuple>(bt)) {}
 
-		func_container(const func_container& other) :ptr_(other.ptr_), bt_(other.bt_) {}
+		closure_container(const closure_container& other) :ptr_(other.ptr_), bt_(other.bt_) {}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		front_applied_type front_apply(front&& arg) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
+		front_applied_type front_apply(front&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<front>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		front_applied_type front_apply(front&& arg) const
+		front_applied_type front_apply(front&& arg, void* buffer) const
 		{
 			auto bt(bt_);
 #ifdef _COPY_ELISION_
-			return new func_container<1, bi, r, as...>(ptr_, shared_tuple<front>(std::forward<front>(arg)), std::move(bt));
+			return emplace<closure_container<F, 1, bi, r, as...>>(buffer, ptr_, shared_tuple<front>(std::forward<front>(arg)), std::move(bt));
 #else
-			return new func_container<1, bi, r, as...>(ptr_, std::make_tuple(std::forward<front>(arg)), std::move(bt));
+			return emplace<closure_container<F, 1, bi, r, as...>>(buffer, ptr_, std::make_tuple(std::forward<front>(arg)), std::move(bt));
 #endif
 		}
 
 		template<typename = std::enable_if_t<applicable::is_unary::value>>
-		back_applied_type back_apply(back&& arg) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
+		back_applied_type back_apply(back&& arg, void* buffer) const { return invoke(std::make_tuple(std::forward<back>(arg))); }
 
 		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
-		back_applied_type back_apply(back&& arg) const
+		back_applied_type back_apply(back&& arg, void* buffer) const
 		{
 #ifdef _COPY_ELISION_
-			return new func_container<0, bi + 1, r, as...>(ptr_, std::move(bt_.push_front(std::forward<back>(arg))));
+			return emplace<closure_container<F, 0, bi + 1, r, as...>>(buffer, ptr_, std::move(bt_.push_front(std::forward<back>(arg))));
 #else
 			auto bt(bt_);
-			return new func_container<0, bi + 1, r, as...>(ptr_, std::tuple_cat(std::make_tuple(arg), std::move(bt)));
+			return emplace<closure_container<F, 0, bi + 1, r, as...>>(buffer, ptr_, std::tuple_cat(std::make_tuple(arg), std::move(bt)));
 #endif
 		}
 
+#ifdef _COPY_ELISION_
+		template<typename ...ps>
+		r call(ps&&...args)const { return std::apply(ptr_, std::tuple_cat(std::forward_as_tuple(std::forward<ps>(args)...), bt_.to_tuple())); }
+#else
+		template<typename ...ps>
+		r call(ps&&...args)const { return call_bound(std::make_index_sequence<bi>(), std::forward<ps>(args)...); }
+#endif
+
 		r invoke(para_tuple&& t)const override
 		{
 #ifdef _COPY_ELISION_ 
@@ -496,23 +735,300 @@ namespace details
 #endif
 		}
 
-		typename applicable::front_applied_type push_front(front&& arg)const override
+		typename applicable::front_applied_type push_front(front&& arg, void* buffer = nullptr)const override
 		{
-			return front_apply(std::forward<front>(arg));
+			return front_apply(std::forward<front>(arg), buffer);
 		}
 
-		typename applicable::back_applied_type push_back(back&& arg)const override
+		typename applicable::back_applied_type push_back(back&& arg, void* buffer = nullptr)const override
 		{
-			return back_apply(std::forward<back>(arg));
+			return back_apply(std::forward<back>(arg), buffer);
 		}
 
-		applicable* new_ptr()const override { return new func_container(*this); }
+		typename applicable::call_type trampoline()const override { return &dispatch<closure_container, r, typename applicable::para_pack>::call; }
+
+		applicable* new_ptr(void* buffer = nullptr)const override { return emplace<closure_container>(buffer, *this); }
+
+		bool is_small()const override { return details::is_small<closure_container>::value; }
 
-		virtual ~func_container() override {}
+		virtual ~closure_container() override {}
 
 	private:
-		details::func_ptr<r, as...> ptr_;
+		F ptr_;
 		back_tuple bt_;
+
+		template<size_t ...J, typename ...ps>
+		r call_bound(std::index_sequence<J...>, ps&&...args)const { return ptr_(std::forward<ps>(args)..., std::get<J>(bt_)...); }
+	};
+
+#ifdef _FLAT_ARGUMENTS_
+	//uninitialized room for one argument
+	template<typename a>
+	struct slot { alignas(a) unsigned char data[sizeof(a)]; };
+
+	//one allocation with a slot for every parameter, the owner knows which slots are built
+	template<typename ...as>
+	struct argument_block
+	{
+		template<size_t i>
+		using arg = std::tuple_element_t<i, std::tuple<std::decay_t<as>...>>;
+
+		template<size_t i, typename v>
+		void construct(v&& value) { new (std::get<i>(slots_).data) arg<i>(std::forward<v>(value)); }
+
+		template<size_t i>
+		const arg<i>& get()const { return *reinterpret_cast<const arg<i>*>(std::get<i>(slots_).data); }
+
+		template<size_t i>
+		void destroy() { reinterpret_cast<arg<i>*>(std::get<i>(slots_).data)->~arg<i>(); }
+
+	private:
+		std::tuple<slot<std::decay_t<as>>...> slots_;
+	};
+
+	template<size_t offset, size_t ...I>
+	std::index_sequence<offset + I...> shift(std::index_sequence<I...>) { return {}; }
+
+	//the first fi and the last bi slots of the block are bound
+	//the only owner fills the next slot in place and hands the block on, a shared one copies it first
+	template<typename F, size_t fi, size_t bi, typename r, typename ...as>
+	struct flat_container :public details::applicable<r, details::inferred_para_list<fi, bi, as...>>
+	{
+		using applicable = details::applicable<r, details::inferred_para_list<fi, bi, as...>>;
+
+		enum { length = sizeof...(as) };
+
+		using target = F;
+
+		using block = argument_block<as...>;
+
+		using para_tuple = typename applicable::para_tuple;
+
+		using front = typename applicable::front;
+
+		using back = typename applicable::back;
+
+		using front_applied_type = typename std::conditional<applicable::is_unary::value, r, flat_container<F, fi + 1, bi, r, as...>*>::type;
+
+		using back_applied_type = typename std::conditional<applicable::is_unary::value, r, flat_container<F, fi, bi + 1, r, as...>*>::type;
+
+		using front_slots = std::make_index_sequence<fi>;
+
+		using back_slots = decltype(shift<length - bi>(std::make_index_sequence<bi>()));
+
+		flat_container() = delete;
+
+		flat_container(F p, std::unique_ptr<block> args) :ptr_(std::move(p)), args_(std::move(args)) {}
+
+		flat_container(const flat_container& other) :ptr_(other.ptr_), args_(other.copy_block()) {}
+
+		template<typename = std::enable_if_t<applicable::is_unary::value>>
+		front_applied_type front_apply(front&& arg, void* buffer) const { return call(std::forward<front>(arg)); }
+
+		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
+		front_applied_type front_apply(front&& arg, void* buffer) const
+		{
+			auto args = copy_block();
+			args->template construct<fi>(std::forward<front>(arg));
+			return new flat_container<F, fi + 1, bi, r, as...>(ptr_, std::move(args));
+		}
+
+		template<typename = std::enable_if_t<applicable::is_unary::value>>
+		front_applied_type front_take(front&& arg) { return call(std::forward<front>(arg)); }
+
+		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
+		front_applied_type front_take(front&& arg)
+		{
+			args_->template construct<fi>(std::forward<front>(arg));
+			return new flat_container<F, fi + 1, bi, r, as...>(std::move(ptr_), std::move(args_));
+		}
+
+		template<typename = std::enable_if_t<applicable::is_unary::value>>
+		back_applied_type back_apply(back&& arg, void* buffer) const { return call(std::forward<back>(arg)); }
+
+		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
+		back_applied_type back_apply(back&& arg, void* buffer) const
+		{
+			auto args = copy_block();
+			args->template construct<length - bi - 1>(std::forward<back>(arg));
+			return new flat_container<F, fi, bi + 1, r, as...>(ptr_, std::move(args));
+		}
+
+		template<typename = std::enable_if_t<applicable::is_unary::value>>
+		back_applied_type back_take(back&& arg) { return call(std::forward<back>(arg)); }
+
+		template<typename = std::enable_if_t<!applicable::is_unary::value>, size_t = 0>
+		back_applied_type back_take(back&& arg)
+		{
+			args_->template construct<length - bi - 1>(std::forward<back>(arg));
+			return new flat_container<F, fi, bi + 1, r, as...>(std::move(ptr_), std::move(args_));
+		}
+
+		template<typename ...ps>
+		r call(ps&&...args)const { return call_bound(front_slots(), back_slots(), std::forward<ps>(args)...); }
+
+		r invoke(para_tuple&& t)const override
+		{
+			return std::apply([this](auto&&...args) { return call(std::forward<decltype(args)>(args)...); }, std::forward<para_tuple>(t));
+		}
+
+		typename applicable::front_applied_type push_front(front&& arg, void* buffer = nullptr)const override
+		{
+			return front_apply(std::forward<front>(arg), buffer);
+		}
+
+		typename applicable::back_applied_type push_back(back&& arg, void* buffer = nullptr)const override
+		{
+			return back_apply(std::forward<back>(arg), buffer);
+		}
+
+		typename applicable::front_applied_type consume_front(front&& arg, void* buffer = nullptr) override
+		{
+			return front_take(std::forward<front>(arg));
+		}
+
+		typename applicable::back_applied_type consume_back(back&& arg, void* buffer = nullptr) override
+		{
+			return back_take(std::forward<back>(arg));
+		}
+
+		typename applicable::call_type trampoline()const override { return &dispatch<flat_container, r, typename applicable::para_pack>::call; }
+
+		applicable* new_ptr(void* buffer = nullptr)const override { return new flat_container(*this); }
+
+		bool is_small()const override { return false; }
+
+		virtual ~flat_container() override { if (args_ != nullptr) destroy(front_slots(), back_slots()); }
+
+	private:
+		F ptr_;
+		std::unique_ptr<block> args_;
+
+		template<size_t ...I, size_t ...J, typename ...ps>
+		r call_bound(std::index_sequence<I...>, std::index_sequence<J...>, ps&&...args)const
+		{
+			return ptr_(args_->template get<I>()..., std::forward<ps>(args)..., args_->template get<J>()...);
+		}
+
+		std::unique_ptr<block> copy_block()const
+		{
+			auto args = std::make_unique<block>();
+			copy_into(*args, front_slots(), back_slots());
+			return args;
+		}
+
+		template<size_t ...I, size_t ...J>
+		void copy_into(block& args, std::index_sequence<I...>, std::index_sequence<J...>)const
+		{
+			using expand = int[];
+			(void)expand { 0, (args.template construct<I>(args_->template get<I>()), 0)..., (args.template construct<J>(args_->template get<J>()), 0)... };
+		}
+
+		template<size_t ...I, size_t ...J>
+		void destroy(std::index_sequence<I...>, std::index_sequence<J...>)
+		{
+			using expand = int[];
+			(void)expand { 0, (args_->template destroy<I>(), 0)..., (args_->template destroy<J>(), 0)... };
+		}
+	};
+#endif
+
+	//container of a plain function pointer
+	template<size_t fi, size_t bi, typename r, typename ...as>
+	using func_container = closure_container<func_ptr<r, as...>, fi, bi, r, as...>;
+
+	//owner of a type erased container
+	//small containers live in the inline buffer, large ones on the heap
+	//a heap container is immutable and shared between copies by its reference count
+	//every container it owns must have been built with its own buffer()
+	template<typename applicable>
+	struct storage
+	{
+		storage() :ptr_(nullptr), call_(nullptr) {}
+
+		storage(const storage& other) :ptr_(nullptr), call_(nullptr) { copy(other); }
+
+		storage(storage&& other) :ptr_(nullptr), call_(nullptr) { take(other); }
+
+		storage& operator=(const storage& other)
+		{
+			if (&other != this)
+			{
+				reset();
+				copy(other);
+			}
+			return *this;
+		}
+
+		storage& operator=(storage&& other)
+		{
+			if (&other != this)
+			{
+				reset();
+				take(other);
+			}
+			return *this;
+		}
+
+		~storage() { reset(); }
+
+		void* buffer() { return &buffer_; }
+
+		const applicable* operator->()const { return ptr_; }
+
+		//the container if nothing else shares it, nullptr otherwise
+		applicable* unique() { return ptr_ != nullptr && !ptr_->is_small() && ptr_->unique() ? ptr_ : nullptr; }
+
+		//one indirect call through the trampoline kept next to the container
+		template<typename ...ps>
+		decltype(auto) call(ps&&...args)const { return call_(ptr_, std::forward<ps>(args)...); }
+
+		void reset(applicable* ptr = nullptr)
+		{
+			if (ptr_ != nullptr)
+			{
+				if (ptr_->is_small()) ptr_->~applicable();
+				else if (ptr_->release()) delete ptr_;
+			}
+			ptr_ = ptr;
+			call_ = ptr == nullptr ? nullptr : ptr->trampoline();
+		}
+
+	private:
+		small_buffer buffer_;
+		applicable* ptr_;
+		typename applicable::call_type call_;
+
+		//an inline container is copied, a heap one only gains a reference
+		void copy(const storage& other)
+		{
+			if (other.ptr_ == nullptr) return;
+			if (other.ptr_->is_small()) ptr_ = other.ptr_->new_ptr(buffer());
+			else
+			{
+				other.ptr_->retain();
+				ptr_ = other.ptr_;
+			}
+			call_ = other.call_;
+		}
+
+		//a heap container changes hands, an inline one is copied as raw trivial arguments
+		void take(storage& other)
+		{
+			if (other.ptr_ == nullptr) return;
+			call_ = other.call_;
+			if (other.ptr_->is_small())
+			{
+				ptr_ = other.ptr_->new_ptr(buffer());
+				other.reset();
+			}
+			else
+			{
+				ptr_ = other.ptr_;
+				other.ptr_ = nullptr;
+				other.call_ = nullptr;
+			}
+		}
 	};
 
 	//return the function type given an return type and a pack of argument type
@@ -556,37 +1072,30 @@ namespace fcl
 		using last = last_parameter<function>;
 
 		template<typename f, typename = std::enable_if_t<std::is_convertible<f, func_ptr>::value>>
-		function(f ptr) :ptr_(new func_con(ptr)) {}
+		function(f ptr) { ptr_.reset(details::emplace<func_con>(ptr_.buffer(), ptr)); }
 
-		function(const function& other) :ptr_(other.ptr_->new_ptr()) {}
+		//any other callable is stored as it is, captures included
+		template<typename f, typename = std::enable_if_t<!std::is_convertible<f, func_ptr>::value && !std::is_same<std::decay_t<f>, function>::value && !details::is_function_ref<std::decay_t<f>>::value && details::is_callable<std::decay_t<f>, r, a, b, rest...>::value>, size_t = 0>
+		function(f&& callable) { ptr_.reset(details::emplace<details::closure_container<std::decay_t<f>, 0, 0, r, a, b, rest...>>(ptr_.buffer(), std::forward<f>(callable))); }
 
-		function(function&& other) :ptr_(other.ptr_) { other.ptr_ = nullptr; }
+		//a reference is turned into a function by copying its target, never by keeping the reference
+		explicit function(const function_ref<r, a, b, rest...>& ref) :function(ref.own()) {}
 
-		function& operator=(const function& other)
-		{
-			if (&other != this)
-				ptr_ = other.ptr_->new_ptr();
-			return *this;
-		}
+		function(const function& other) = default;
 
-		function& operator=(function && other)
-		{
-			ptr_ = other.ptr_;
-			other.ptr_ = nullptr;
-			return *this;
-		}
+		function(function&& other) = default;
 
-		r operator()(a first, b second, rest...args)const { return ptr_->invoke(std::forward_as_tuple(first, second, args...)); }
+		function& operator=(const function& other) = default;
 
-		~function() { delete ptr_; }
+		function& operator=(function&& other) = default;
 
+		r operator()(a first, b second, rest...args)const { return ptr_.call(std::forward<a>(first), std::forward<b>(second), std::forward<rest>(args)...); }
 
 	private:
 
-		applicable * ptr_;
+		details::storage<applicable> ptr_;
 
-		function() :ptr_(nullptr) {};
-		function(applicable* ptr) :ptr_(ptr) {};
+		function() = default;
 	};
 
 	//unary function container definition
@@ -607,36 +1116,30 @@ namespace fcl
 	public:
 
 		template<typename f, typename = std::enable_if_t<std::is_convertible<f, func_ptr>::value>>
-		function(f ptr) :ptr_(new func_con(ptr)) {}
+		function(f ptr) { ptr_.reset(details::emplace<func_con>(ptr_.buffer(), ptr)); }
 
-		function(const function& other) :ptr_(other.ptr_->new_ptr()) {}
+		//any other callable is stored as it is, captures included
+		template<typename f, typename = std::enable_if_t<!std::is_convertible<f, func_ptr>::value && !std::is_same<std::decay_t<f>, function>::value && !details::is_function_ref<std::decay_t<f>>::value && details::is_callable<std::decay_t<f>, r, a>::value>, size_t = 0>
+		function(f&& callable) { ptr_.reset(details::emplace<details::closure_container<std::decay_t<f>, 0, 0, r, a>>(ptr_.buffer(), std::forward<f>(callable))); }
 
-		function(function&& other) :ptr_(other.ptr_) { other.ptr_ = nullptr; }
+		//a reference is turned into a function by copying its target, never by keeping the reference
+		explicit function(const function_ref<r, a>& ref) :function(ref.own()) {}
 
-		function& operator=(const function& other)
-		{
-			if (&other != this)
-				ptr_ = other.ptr_->new_ptr();
-			return *this;
-		}
+		function(const function& other) = default;
 
-		function& operator=(function&& other)
-		{
-			ptr_ = other.ptr_;
-			other.ptr_ = nullptr;
-			return *this;
-		}
+		function(function&& other) = default;
+
+		function& operator=(const function& other) = default;
 
-		r operator()(a arg)const { return ptr_->invoke(std::forward_as_tuple(arg)); }
+		function& operator=(function&& other) = default;
 
-		~function() { delete ptr_; }
+		r operator()(a arg)const { return ptr_.call(std::forward<a>(arg)); }
 
 	private:
 
-		applicable * ptr_;
+		details::storage<applicable> ptr_;
 
-		function() :ptr_(nullptr) {};
-		function(applicable* ptr) :ptr_(ptr) {};
+		function() = default;
 	};
 
 	//function type trait definition
@@ -653,12 +1156,37 @@ namespace fcl
 
 		static applied apply(const f& func, head&& arg)
 		{
-			return applied(func.ptr_->push_front(std::forward<head>(arg)));
+			applied result;
+			result.ptr_.reset(func.ptr_->push_front(std::forward<head>(arg), result.ptr_.buffer()));
+			return result;
 		}
 
 		static monadic_applied monadic_apply(const f& func, last&& arg)
 		{
-			return monadic_applied(func.ptr_->push_back(std::forward<last>(arg)));
+			monadic_applied result;
+			result.ptr_.reset(func.ptr_->push_back(std::forward<last>(arg), result.ptr_.buffer()));
+			return result;
+		}
+
+		//an rvalue that is the only owner of its container hands it over to the result
+		static applied apply(f&& func, head&& arg)
+		{
+			auto unique = func.ptr_.unique();
+			if (unique == nullptr) return apply(static_cast<const f&>(func), std::forward<head>(arg));
+			applied result;
+			result.ptr_.reset(unique->consume_front(std::forward<head>(arg), result.ptr_.buffer()));
+			func.ptr_.reset();
+			return result;
+		}
+
+		static monadic_applied monadic_apply(f&& func, last&& arg)
+		{
+			auto unique = func.ptr_.unique();
+			if (unique == nullptr) return monadic_apply(static_cast<const f&>(func), std::forward<last>(arg));
+			monadic_applied result;
+			result.ptr_.reset(unique->consume_back(std::forward<last>(arg), result.ptr_.buffer()));
+			func.ptr_.reset();
+			return result;
 		}
 	};
 
@@ -676,14 +1204,93 @@ namespace fcl
 
 		static r apply(const f& func, a&& arg)
 		{
-			return func.ptr_->invoke(std::make_tuple<a>(std::forward<a>(arg)));
+			return func.ptr_.call(std::forward<a>(arg));
 		}
 
 		static r monadic_apply(const f& func, a&& arg)
 		{
-			return func.ptr_->invoke(std::make_tuple<a>(std::forward<a>(arg)));
+			return func.ptr_.call(std::forward<a>(arg));
 		}
 	};
+
+	//non-owning reference to a callable, it has to outlive every call made through the reference
+	//copying is two pointers and a call is one indirect call, nothing is allocated
+	//partial application copies the target into an owning function first
+	template<typename r, typename a, typename ...as>
+	struct function_ref
+	{
+	private:
+		using func_ptr = details::func_ptr<r, a, as...>;
+
+		//a function pointer is kept by value, anything else by address
+		union target
+		{
+			const void* obj;
+			func_ptr fn;
+		};
+
+	public:
+		template<typename f, typename = std::enable_if_t<std::is_convertible<f, func_ptr>::value>>
+		function_ref(const f& ptr) :call_(&call_pointer), own_(&own_pointer) { target_.fn = ptr; }
+
+		template<typename f, typename = std::enable_if_t<!std::is_convertible<f, func_ptr>::value && !std::is_same<f, function_ref>::value && details::is_callable<f, r, a, as...>::value>, size_t = 0>
+		function_ref(const f& callable) :call_(&call_object<f>), own_(&own_object<f>) { target_.obj = &callable; }
+
+		r operator()(a first, as...args)const { return call_(target_, std::forward<a>(first), std::forward<as>(args)...); }
+
+		//an owning function holding a copy of the target
+		function<r, a, as...> own()const { return own_(target_); }
+
+	private:
+		target target_;
+		r(*call_)(const target&, a, as...);
+		function<r, a, as...>(*own_)(const target&);
+
+		static r call_pointer(const target& t, a first, as...args) { return t.fn(std::forward<a>(first), std::forward<as>(args)...); }
+
+		template<typename f>
+		static r call_object(const target& t, a first, as...args) { return (*static_cast<const f*>(t.obj))(std::forward<a>(first), std::forward<as>(args)...); }
+
+		static function<r, a, as...> own_pointer(const target& t) { return function<r, a, as...>(t.fn); }
+
+		template<typename f>
+		static function<r, a, as...> own_object(const target& t) { return function<r, a, as...>(*static_cast<const f*>(t.obj)); }
+	};
+
+	//function reference type trait definition, applying owns the target
+	template<typename r, typename a, typename b, typename ...rest>
+	struct function_traits<function_ref<r, a, b, rest...>>
+	{
+		using f = function_ref<r, a, b, rest...>;
+		using owned = function_traits<function<r, a, b, rest...>>;
+		using possess = std::true_type;
+		using type = typename owned::type;
+		using applied = typename owned::applied;
+		using monadic_applied = typename owned::monadic_applied;
+		using head = a;
+		using last = typename owned::last;
+
+		static applied apply(const f& func, head&& arg) { return owned::apply(func.own(), std::forward<head>(arg)); }
+
+		static monadic_applied monadic_apply(const f& func, last&& arg) { return owned::monadic_apply(func.own(), std::forward<last>(arg)); }
+	};
+
+	//unary function reference type trait definition, applying is calling
+	template<typename r, typename a>
+	struct function_traits<function_ref<r, a>>
+	{
+		using f = function_ref<r, a>;
+		using possess = std::true_type;
+		using type = TMP::Pack<a, r>;
+		using applied = r;
+		using monadic_applied = r;
+		using head = a;
+		using last = a;
+
+		static r apply(const f& func, a&& arg) { return func(std::forward<a>(arg)); }
+
+		static r monadic_apply(const f& func, a&& arg) { return func(std::forward<a>(arg)); }
+	};
 }
 
 
@@ -0,0 +1,79 @@
+/*
+* fused.cpp
+* testing file for fused.h
+* no actual implenmetaion included
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#pragma once
+#ifdef FUSED_CPP
+
+#include "fused.h"
+#include <cctype>
+#include <iostream>
+
+using namespace fcl;
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+bool is_alpha(char c) { return isalpha(static_cast<unsigned char>(c)) != 0; }
+
+//the JSON number grammar, matched as one span
+auto json_number()
+{
+	auto digit = fused::satisfy(is_digit);
+	auto digits = fused::skip_many1(digit);
+	auto integer = fused::optional(fused::ch('-')) >> (fused::lit("0") || (fused::satisfy([](char c) { return c >= '1' && c <= '9'; }) >> fused::skip_many(digit)));
+	auto fraction = fused::optional(fused::ch('.') >> digits);
+	auto exponent = fused::optional((fused::ch('e') || fused::ch('E')) >> fused::optional(fused::ch('+') || fused::ch('-')) >> digits);
+	return fused::token(fused::capture(fused::sequence([](na, bool, bool) { return na(); }, integer, fraction, exponent)) >>= [](fused::span s) { return std::stod(s.str()); });
+}
+
+//expr/term/factor of parser.cpp, recursion goes through rules
+bool expr(const char*& s, const char* last, int& out);
+
+bool factor(const char*& s, const char* last, int& out)
+{
+	const static auto P =
+		(fused::satisfy(is_digit) >>= [](char c) { return c - '0'; }) ||
+		(fused::ch('(') >> fused::sequence([](int v, char) { return v; }, fused::rule(expr), fused::ch(')')));
+	return P.run(s, last, out);
+}
+
+bool term(const char*& s, const char* last, int& out)
+{
+	const static auto P =
+		fused::sequence([](int a, char, int b) { return a * b; }, fused::rule(factor), fused::ch('*'), fused::rule(term)) ||
+		fused::rule(factor);
+	return P.run(s, last, out);
+}
+
+bool expr(const char*& s, const char* last, int& out)
+{
+	const static auto P =
+		fused::sequence([](int a, char, int b) { return a + b; }, fused::rule(term), fused::ch('+'), fused::rule(expr)) ||
+		fused::rule(term);
+	return P.run(s, last, out);
+}
+
+int main()
+{
+	Parser<double> number = fused::to_parser(json_number());
+	for (std::string str : { " -12.5e2 ,", "0", "01", "-", "--1", "3.", "1.5.5", "1E+3" })
+		std::cout << "number " << Show<std::string>::show(str) << ": " << parse(number, str) << std::endl;
+
+	Parser<int> calc = fused::to_parser(fused::rule(expr));
+	for (std::string str : { "1+2*3", "(1+2)*3", "2*(3+4)+1x" })
+		std::cout << "expr " << str << ": " << parse(calc, str) << std::endl;
+
+	//type-erased parsers can be used inside a fused grammar
+	auto keyword = fused::from_parser(fcl::string("let")) >> fused::token(fused::capture(fused::skip_many1(fused::satisfy(is_alpha))));
+	std::cout << "let binding: " << parse(fused::to_parser(keyword), "let  x = 1") << std::endl;
+
+	auto list = fused::ch('[') >> fused::sequence([](fcl::list<fused::span> xs, char) { return xs.size(); },
+		fused::many(fused::token(fused::capture(fused::skip_many1(fused::satisfy(is_digit)))) >>= [](fused::span s) { return s; }), fused::ch(']'));
+	std::cout << "list items: " << parse(fused::to_parser(list), "[1 22 333]") << std::endl;
+	std::cout << "size of the list grammar: " << sizeof(list) << " bytes, no heap nodes" << std::endl;
+}
+
+#endif
@@ -0,0 +1,439 @@
+/*
+*   fused.h:
+*   Statically typed parser combinators that compile into one function
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	every fused parser is its own type, a grammar is an expression template
+*	combinators hold their operands by value and call them directly, so a grammar
+*	inlines into one function without fcl::function, virtual calls or heap nodes
+*	a parser runs on a pair of pointers: run(s, last, out) advances s and writes out on success
+*	and leaves s untouched on failure
+*	to_parser wraps a fused grammar into the type-erased Parser<a> at a boundary
+*	from_parser does the opposite, rule breaks the recursion of recursive grammars
+*	value types have to be default constructible
+*
+*   Public Interface:
+*	auto digits = fused::skip_many1(fused::satisfy([](char c) { return c >= '0' && c <= '9'; }));
+*	auto num = fused::capture(fused::optional(fused::ch('-')) >> digits);
+*	auto sign = fused::ch('-') || fused::succeed('+');
+*	auto pair = fused::sequence([](span k, span v) { ... }, key, fused::ch(':') >> value);
+*	auto words = fused::token(fused::lit("null")) >>= [](na) { return 0; };
+*	Parser<span> p = fused::to_parser(fused::capture(digits));
+*
+*   Build Process:
+*   requires parser.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _FUSED_
+#define _FUSED_
+
+#include "parser.h"
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+
+namespace fcl
+{
+	namespace fused
+	{
+		//a matched piece of the input
+		struct span
+		{
+			const char* first;
+			const char* last;
+
+			size_t size()const { return last - first; }
+
+			std::string str()const { return std::string(first, last); }
+		};
+
+		//every fused parser derives from base, the operators below only take part for them
+		template<typename d>
+		struct base {};
+
+		template<typename T>
+		using is_fused = std::is_base_of<base<T>, T>;
+
+		template<typename p>
+		using value_of = typename p::value_type;
+
+		//one character that satisfies pred
+		template<typename pred>
+		struct satisfy_t :base<satisfy_t<pred>>
+		{
+			using value_type = char;
+
+			pred test;
+
+			explicit satisfy_t(pred t) :test(std::move(t)) {}
+
+			bool run(const char*& s, const char* last, char& out)const
+			{
+				if (s == last || !test(*s)) return false;
+				out = *s++;
+				return true;
+			}
+		};
+
+		struct char_t :base<char_t>
+		{
+			using value_type = char;
+
+			char c;
+
+			explicit char_t(char ch) :c(ch) {}
+
+			bool run(const char*& s, const char* last, char& out)const
+			{
+				if (s == last || *s != c) return false;
+				out = *s++;
+				return true;
+			}
+		};
+
+		//a fixed string
+		struct literal_t :base<literal_t>
+		{
+			using value_type = na;
+
+			const char* text;
+			size_t size;
+
+			explicit literal_t(const char* t) :text(t), size(std::strlen(t)) {}
+
+			bool run(const char*& s, const char* last, na&)const
+			{
+				if (static_cast<size_t>(last - s) < size || std::memcmp(s, text, size) != 0) return false;
+				s += size;
+				return true;
+			}
+		};
+
+		//consumes nothing and yields value
+		template<typename a>
+		struct succeed_t :base<succeed_t<a>>
+		{
+			using value_type = a;
+
+			a value;
+
+			explicit succeed_t(a v) :value(std::move(v)) {}
+
+			bool run(const char*&, const char*, a& out)const
+			{
+				out = value;
+				return true;
+			}
+		};
+
+		//left then right, keeps the value of right
+		template<typename l, typename r>
+		struct then_t :base<then_t<l, r>>
+		{
+			using value_type = value_of<r>;
+
+			l left;
+			r right;
+
+			then_t(l x, r y) :left(std::move(x)), right(std::move(y)) {}
+
+			bool run(const char*& s, const char* last, value_type& out)const
+			{
+				const char* start = s;
+				value_of<l> ignored;
+				if (left.run(s, last, ignored) && right.run(s, last, out)) return true;
+				s = start;
+				return false;
+			}
+		};
+
+		//left, or right from the same position
+		template<typename l, typename r>
+		struct or_t :base<or_t<l, r>>
+		{
+			static_assert(std::is_same<value_of<l>, value_of<r>>::value, "alternatives must have one value type");
+
+			using value_type = value_of<l>;
+
+			l left;
+			r right;
+
+			or_t(l x, r y) :left(std::move(x)), right(std::move(y)) {}
+
+			bool run(const char*& s, const char* last, value_type& out)const { return left.run(s, last, out) || right.run(s, last, out); }
+		};
+
+		//the value of p passed through f
+		template<typename p, typename f>
+		struct map_t :base<map_t<p, f>>
+		{
+			using value_type = std::decay_t<decltype(std::declval<const f&>()(std::declval<value_of<p>>()))>;
+
+			p inner;
+			f func;
+
+			map_t(p x, f g) :inner(std::move(x)), func(std::move(g)) {}
+
+			bool run(const char*& s, const char* last, value_type& out)const
+			{
+				value_of<p> v;
+				if (!inner.run(s, last, v)) return false;
+				out = func(std::move(v));
+				return true;
+			}
+		};
+
+		//ps in order, their values passed to f
+		template<typename f, typename ...ps>
+		struct sequence_t :base<sequence_t<f, ps...>>
+		{
+			using value_type = std::decay_t<decltype(std::declval<const f&>()(std::declval<value_of<ps>>()...))>;
+
+			f func;
+			std::tuple<ps...> parsers;
+
+			sequence_t(f g, ps...xs) :func(std::move(g)), parsers(std::move(xs)...) {}
+
+			bool run(const char*& s, const char* last, value_type& out)const { return run(s, last, out, std::index_sequence_for<ps...>()); }
+
+		private:
+			template<size_t ...i>
+			bool run(const char*& s, const char* last, value_type& out, std::index_sequence<i...>)const
+			{
+				const char* start = s;
+				std::tuple<value_of<ps>...> values;
+				//a braced list runs left to right, ok stops the parsers after the first failure
+				bool ok = true;
+				(void)std::initializer_list<int>{ (ok = ok && std::get<i>(parsers).run(s, last, std::get<i>(values)), 0)... };
+				if (!ok)
+				{
+					s = start;
+					return false;
+				}
+				out = func(std::move(std::get<i>(values))...);
+				return true;
+			}
+		};
+
+		//p if it matches, the value tells whether it did
+		template<typename p>
+		struct optional_t :base<optional_t<p>>
+		{
+			using value_type = bool;
+
+			p inner;
+
+			explicit optional_t(p x) :inner(std::move(x)) {}
+
+			bool run(const char*& s, const char* last, bool& out)const
+			{
+				value_of<p> v;
+				out = inner.run(s, last, v);
+				return true;
+			}
+		};
+
+		//p repeated at least min times, the values are dropped
+		template<typename p>
+		struct skip_many_t :base<skip_many_t<p>>
+		{
+			using value_type = na;
+
+			p inner;
+			size_t min;
+
+			skip_many_t(p x, size_t m) :inner(std::move(x)), min(m) {}
+
+			bool run(const char*& s, const char* last, na&)const
+			{
+				const char* start = s;
+				size_t n = 0;
+				value_of<p> v;
+				//a match that consumes nothing would repeat forever
+				for (const char* before = s; inner.run(s, last, v) && s != before; before = s) ++n;
+				if (n >= min) return true;
+				s = start;
+				return false;
+			}
+		};
+
+		//p repeated, the values collected in a list
+		template<typename p>
+		struct many_t :base<many_t<p>>
+		{
+			using value_type = list<value_of<p>>;
+
+			p inner;
+			size_t min;
+
+			many_t(p x, size_t m) :inner(std::move(x)), min(m) {}
+
+			bool run(const char*& s, const char* last, value_type& out)const
+			{
+				const char* start = s;
+				value_type r;
+				value_of<p> v;
+				for (const char* before = s; inner.run(s, last, v) && s != before; before = s) r.push_back(std::move(v));
+				if (r.size() < min)
+				{
+					s = start;
+					return false;
+				}
+				out = std::move(r);
+				return true;
+			}
+		};
+
+		//the input p matched instead of its value
+		template<typename p>
+		struct capture_t :base<capture_t<p>>
+		{
+			using value_type = span;
+
+			p inner;
+
+			explicit capture_t(p x) :inner(std::move(x)) {}
+
+			bool run(const char*& s, const char* last, span& out)const
+			{
+				const char* start = s;
+				value_of<p> v;
+				if (!inner.run(s, last, v)) return false;
+				out = span{ start, s };
+				return true;
+			}
+		};
+
+		//a grammar defined by a function, for recursion
+		template<typename a>
+		struct rule_t :base<rule_t<a>>
+		{
+			using value_type = a;
+
+			bool(*func)(const char*&, const char*, a&);
+
+			explicit rule_t(bool(*f)(const char*&, const char*, a&)) :func(f) {}
+
+			bool run(const char*& s, const char* last, a& out)const { return func(s, last, out); }
+		};
+
+		//a type-erased Parser inside a fused grammar, the view it parses has no owner
+		template<typename a>
+		struct erased_t :base<erased_t<a>>
+		{
+			using value_type = a;
+
+			Parser<a> inner;
+
+			explicit erased_t(Parser<a> x) :inner(std::move(x)) {}
+
+			bool run(const char*& s, const char* last, a& out)const
+			{
+				auto r = parse(inner, cursor(s, last));
+				if (isNothing(r)) return false;
+				auto pair = fromJust(std::move(r));
+				out = std::move(pair.first);
+				s = pair.second.data();
+				return true;
+			}
+		};
+
+		template<typename pred>
+		satisfy_t<pred> satisfy(pred test) { return satisfy_t<pred>(std::move(test)); }
+
+		inline char_t ch(char c) { return char_t(c); }
+
+		inline literal_t lit(const char* text) { return literal_t(text); }
+
+		template<typename a>
+		succeed_t<a> succeed(a value) { return succeed_t<a>(std::move(value)); }
+
+		template<typename f, typename ...ps>
+		sequence_t<f, ps...> sequence(f func, ps...parsers) { return sequence_t<f, ps...>(std::move(func), std::move(parsers)...); }
+
+		template<typename p>
+		optional_t<p> optional(p inner) { return optional_t<p>(std::move(inner)); }
+
+		template<typename p>
+		skip_many_t<p> skip_many(p inner) { return skip_many_t<p>(std::move(inner), 0); }
+
+		template<typename p>
+		skip_many_t<p> skip_many1(p inner) { return skip_many_t<p>(std::move(inner), 1); }
+
+		template<typename p>
+		many_t<p> many(p inner) { return many_t<p>(std::move(inner), 0); }
+
+		template<typename p>
+		many_t<p> many1(p inner) { return many_t<p>(std::move(inner), 1); }
+
+		template<typename p>
+		capture_t<p> capture(p inner) { return capture_t<p>(std::move(inner)); }
+
+		template<typename a>
+		rule_t<a> rule(bool(*func)(const char*&, const char*, a&)) { return rule_t<a>(func); }
+
+		template<typename a>
+		erased_t<a> from_parser(Parser<a> p) { return erased_t<a>(std::move(p)); }
+
+		inline auto spaces()
+		{
+			return skip_many(satisfy([](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }));
+		}
+
+		//p with the whitespace around it skipped, as fcl::token
+		template<typename p>
+		auto token(p inner)
+		{
+			return sequence([](na, value_of<p> v, na) { return v; }, spaces(), std::move(inner), spaces());
+		}
+
+		template<typename l, typename r, typename = std::enable_if_t<is_fused<l>::value && is_fused<r>::value>>
+		then_t<l, r> operator>>(l x, r y) { return then_t<l, r>(std::move(x), std::move(y)); }
+
+		template<typename l, typename r, typename = std::enable_if_t<is_fused<l>::value && is_fused<r>::value>>
+		or_t<l, r> operator||(l x, r y) { return or_t<l, r>(std::move(x), std::move(y)); }
+
+		template<typename p, typename f, typename = std::enable_if_t<is_fused<p>::value && !is_fused<f>::value>>
+		map_t<p, f> operator>>=(p x, f g) { return map_t<p, f>(std::move(x), std::move(g)); }
+
+		//the boundary back to the type-erased Parser, only the rest of the input keeps the owner of inp
+		//spans and cursors inside the value point into the buffer without an owner, like erased_t,
+		//so they are valid only while the caller keeps that buffer alive
+		template<typename p, typename = std::enable_if_t<is_fused<p>::value>>
+		Parser<value_of<p>> to_parser(p grammar)
+		{
+			using a = value_of<p>;
+			return [g = std::move(grammar)](cursor inp)->Reaction<a>
+			{
+				const char* s = inp.data();
+				a value;
+				if (!g.run(s, inp.end(), value)) return Nothing();
+				return reaction(std::move(value), inp.drop(s - inp.data()));
+			};
+		}
+	}
+
+	template<>
+	struct Show<fused::span>
+	{
+		using pertain = std::true_type;
+		static std::string show(const fused::span& value) { return Show<std::string>::show(value.str()); }
+	};
+}
+
+#endif
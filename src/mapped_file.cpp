@@ -0,0 +1,136 @@
+/*
+* mapped_file.cpp
+* implenmentation and test stub for mapped_file.h
+* Yunsheng Guo yguo125@syr.edu
+*/
+
+#include "mapped_file.h"
+#include <exception>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace details
+{
+	//unmaps on destruction, owned by every cursor into the file
+	struct mapping
+	{
+		const char* data;
+		size_t size;
+
+		mapping(const mapping&) = delete;
+		mapping& operator=(const mapping&) = delete;
+
+#ifdef _WIN32
+		HANDLE file;
+		HANDLE map;
+
+		mapping(const std::string& path) :data(nullptr), size(0), file(INVALID_HANDLE_VALUE), map(nullptr)
+		{
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) throw std::exception("error: cannot open file.");
+			LARGE_INTEGER length;
+			if (!GetFileSizeEx(file, &length))
+			{
+				CloseHandle(file);
+				throw std::exception("error: cannot read file size.");
+			}
+			size = static_cast<size_t>(length.QuadPart);
+			if (size == 0) return;
+			map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (map != nullptr) data = static_cast<const char*>(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0));
+			if (data == nullptr)
+			{
+				if (map != nullptr) CloseHandle(map);
+				CloseHandle(file);
+				throw std::exception("error: cannot map file.");
+			}
+		}
+
+		~mapping()
+		{
+			if (data != nullptr) UnmapViewOfFile(data);
+			if (map != nullptr) CloseHandle(map);
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		}
+#else
+		mapping(const std::string& path) :data(nullptr), size(0)
+		{
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) throw std::exception("error: cannot open file.");
+			struct stat st;
+			if (fstat(fd, &st) != 0)
+			{
+				close(fd);
+				throw std::exception("error: cannot read file size.");
+			}
+			size = static_cast<size_t>(st.st_size);
+			if (size == 0)
+			{
+				close(fd);
+				return;
+			}
+			void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			//the mapping stays valid after the descriptor is closed
+			close(fd);
+			if (p == MAP_FAILED) throw std::exception("error: cannot map file.");
+			madvise(p, size, MADV_SEQUENTIAL);
+			data = static_cast<const char*>(p);
+		}
+
+		~mapping()
+		{
+			if (data != nullptr) munmap(const_cast<char*>(data), size);
+		}
+#endif
+	};
+}
+
+fcl::cursor fcl::map_file(const std::string& path)
+{
+	auto m = std::make_shared<const details::mapping>(path);
+	if (m->size == 0) return cursor();
+	return cursor(m->data, m->data + m->size, m);
+}
+
+#ifdef MAPPED_FILE_CPP
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+using namespace fcl;
+
+int main()
+{
+	const char* path = "mapped_file_test.txt";
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << "mapped file content";
+	}
+
+	cursor c = map_file(path);
+	std::cout << "mapped length: " << c.length() << std::endl;
+	std::cout << "mapped content: " << c.str() << std::endl;
+	cursor w = c.drop(7);
+	c = cursor();
+	std::cout << "still mapped through a copy: " << w.take(4).str() << std::endl;
+
+	{
+		std::ofstream out(path, std::ios::binary);
+	}
+	std::cout << "empty file is empty: " << map_file(path).empty() << std::endl;
+	std::remove(path);
+
+	try { map_file("no_such_file.txt"); }
+	catch (std::exception& e) { std::cout << "missing file: " << e.what() << std::endl; }
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*
+*   mapped_file.h:
+*   Read-only memory mapped files as parser input
+*   Language: C++, Visual Studio 2017
+*   Platform: Windows 10 Pro
+*   Application: recreational
+*   Author: Yunsheng Guo, yguo125@syr.edu
+*/
+
+
+/*
+*
+*   Package Operations:
+*	maps a whole file read-only (mmap on POSIX, a file mapping on Windows)
+*	and returns a cursor viewing the mapped pages
+*	the mapping is the cursor's owner, it is released when the last cursor into it is gone
+*	pages are served from the OS page cache, nothing is copied into a std::string
+*
+*   Public Interface:
+*	cursor c = map_file("dump.json");
+*	auto r = parse(p, map_file("input.txt"));
+*
+*   Build Process:
+*   requires cursor.h
+*
+*   Maintenance History:
+*   October 18
+*   first draft
+*
+*
+*/
+
+#pragma once
+#ifndef _MAPPED_FILE_
+#define _MAPPED_FILE_
+
+#include "cursor.h"
+
+namespace fcl
+{
+	//map the file at path, throw if it cannot be opened or mapped
+	//an empty file gives an empty cursor
+	cursor map_file(const std::string& path);
+}
+
+#endif
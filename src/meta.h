@@ -28,6 +28,8 @@
 *   refactor into a forward declaration header with some useful stuff
 *	August 25
 *	final review for publish
+*	October 18
+*	<< and >>= on an rvalue function let it hand its bound arguments over
 *
 *
 */
@@ -55,6 +57,10 @@ namespace fcl
 	template<typename r, typename a, typename ...as>
 	struct function;
 
+	//non-owning reference to a callable, in the same form as function
+	template<typename r, typename a, typename ...as>
+	struct function_ref;
+
 	//indirect TMF function definition
 	template<typename f>
 	struct function_traits
@@ -112,6 +118,21 @@ namespace fcl
 		return function_traits<f>::apply(func, std::move(arg_));
 	}
 
+	//an rvalue function may give its bound arguments to the result instead of copying them
+	//an lvalue deduces f as a reference, which has no function_traits
+	template<typename f, typename = std::enable_if_t<is_function<f>::value>>
+	applied_type<f> operator<<(f&& func, head_parameter<f>&& arg)
+	{
+		return function_traits<f>::apply(std::move(func), std::forward<head_parameter<f>>(arg));
+	}
+
+	template<typename f, typename = std::enable_if_t<is_function<f>::value>>
+	applied_type<f> operator<<(f&& func, const head_parameter<f>& arg)
+	{
+		auto arg_(arg);
+		return function_traits<f>::apply(std::move(func), std::move(arg_));
+	}
+
 	template<typename f, typename = std::enable_if_t<is_function<f>::value>>
 	monadic_applied_type<f> operator>>=(last_parameter<f>&& arg, const f& func)
 	{
@@ -125,6 +146,19 @@ namespace fcl
 		return function_traits<f>::monadic_apply(func, std::move(arg_));
 	}
 
+	template<typename f, typename = std::enable_if_t<is_function<f>::value>>
+	monadic_applied_type<f> operator>>=(last_parameter<f>&& arg, f&& func)
+	{
+		return function_traits<f>::monadic_apply(std::move(func), std::forward<last_parameter<f>>(arg));
+	}
+
+	template<typename f, typename = std::enable_if_t<is_function<f>::value>>
+	monadic_applied_type<f> operator>>=(const last_parameter<f>& arg, f&& func)
+	{
+		auto arg_(arg);
+		return function_traits<f>::monadic_apply(std::move(func), std::move(arg_));
+	}
+
 	//generic or type container forward declaration
 	template<typename a, typename b, typename ...rest>
 	struct variant;
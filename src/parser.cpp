@@ -10,76 +10,218 @@
 
 #include "parser.h"
 
+#if defined(__SSSE3__) || defined(__AVX__)
+#define PARSER_SSSE3
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 using namespace fcl;
 
-Reaction<char> fcl::item(std::string inp)
+fcl::char_class::char_class() :table_(std::make_shared<details::class_table>())
+{
+	for (auto& m : table_->member) m = false;
+	build();
+}
+
+fcl::char_class::char_class(function_ref<bool, char> p) :char_class()
+{
+	for (int i = 0; i < 256; ++i) table_->member[i] = p(static_cast<char>(i));
+	build();
+}
+
+char_class fcl::char_class::range(char first, char last)
+{
+	char_class c;
+	for (int i = static_cast<unsigned char>(first); i <= static_cast<unsigned char>(last); ++i) c.table_->member[i] = true;
+	c.build();
+	return c;
+}
+
+char_class fcl::char_class::of(const std::string& chars)
+{
+	char_class c;
+	for (char ch : chars) c.table_->member[static_cast<unsigned char>(ch)] = true;
+	c.build();
+	return c;
+}
+
+char_class fcl::char_class::operator|(const char_class& other)const
+{
+	char_class c;
+	for (int i = 0; i < 256; ++i) c.table_->member[i] = table_->member[i] || other.table_->member[i];
+	c.build();
+	return c;
+}
+
+char_class fcl::char_class::operator~()const
+{
+	char_class c;
+	for (int i = 0; i < 256; ++i) c.table_->member[i] = !table_->member[i];
+	c.build();
+	return c;
+}
+
+void fcl::char_class::build()
+{
+	auto& t = *table_;
+	t.ascii = true;
+	for (int i = 128; i < 256; ++i) if (t.member[i]) t.ascii = false;
+	for (int l = 0; l < 16; ++l)
+	{
+		t.low[l] = 0;
+		for (int h = 0; h < 8; ++h) if (t.member[h * 16 + l]) t.low[l] |= static_cast<unsigned char>(1 << h);
+	}
+}
+
+namespace
 {
-	if (inp.length() == 0) return Nothing();
-	return uncons_str(inp);
+	unsigned first_set(unsigned mask)
+	{
+#ifdef _MSC_VER
+		unsigned long i;
+		_BitScanForward(&i, mask);
+		return i;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
 }
 
-Parser<char> fcl::sat(function<bool, char> p)
+const char* fcl::char_class::scan(const char* p, const char* last)const
 {
-	const static function<Reaction<char>, function<bool, char>, std::string> sat_impl =
-		[](function<bool, char> p, std::string inp)->Reaction<char>
+	const auto& t = *table_;
+#ifdef PARSER_SSSE3
+	//bytes above 0x7F get no bit from the high nibble table, so only ascii classes qualify
+	if (t.ascii && last - p >= 16)
 	{
-		if (inp.length() == 0) return Nothing();
-		auto pair = uncons_str(inp);
-		if (p(pair.first)) return pair;
-		return Nothing();
+		const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.low));
+		const __m128i high = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m128i nibble = _mm_set1_epi8(0x0F);
+		const __m128i zero = _mm_setzero_si128();
+		for (; last - p >= 16; p += 16)
+		{
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			__m128i bits = _mm_and_si128(
+				_mm_shuffle_epi8(low, _mm_and_si128(x, nibble)),
+				_mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+			unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bits, zero)));
+			if (mask != 0) return p + first_set(mask);
+		}
+	}
+#endif
+	while (p != last && t.member[static_cast<unsigned char>(*p)]) ++p;
+	return p;
+}
+
+namespace
+{
+	const char_class& digits() { const static auto c = char_class::range('0', '9'); return c; }
+
+	const char_class& lowers() { const static auto c = char_class::range('a', 'z'); return c; }
+
+	const char_class& uppers() { const static auto c = char_class::range('A', 'Z'); return c; }
+
+	const char_class& letters() { const static auto c = lowers() | uppers(); return c; }
+
+	const char_class& alphanumerics() { const static auto c = letters() | digits(); return c; }
+
+	const char_class& hexdigits() { const static auto c = digits() | char_class::range('a', 'f') | char_class::range('A', 'F'); return c; }
+
+	const char_class& spaces() { const static auto c = char_class::of(" \t\n\v\f\r"); return c; }
+}
+
+Reaction<char> fcl::item(cursor inp)
+{
+	if (inp.empty()) return Nothing();
+	return uncons_str(std::move(inp));
+}
+
+Parser<char> fcl::sat(function_ref<bool, char> p) { return sat(char_class(p)); }
+
+Parser<char> fcl::sat(char_class c)
+{
+	const static function<Reaction<char>, char_class, cursor> sat_impl =
+		[](char_class c1, cursor inp)->Reaction<char>
+	{
+		if (inp.empty() || !c1.contains(inp.head())) return Nothing();
+		return uncons_str(std::move(inp));
 	};
 
-	return sat_impl << p;
+	return sat_impl << std::move(c);
 }
 
-Reaction<char> fcl::digit(std::string inp)
+Parser<cursor> fcl::take_while(char_class c)
 {
-	const static auto P = sat([](char c)->bool {return isdigit(c) != 0; });
-	return parse(P, std::move(inp));
+	const static function<Reaction<cursor>, char_class, cursor> take_while_impl =
+		[](char_class c1, cursor inp)->Reaction<cursor>
+	{
+		size_t n = c1.scan(inp.data(), inp.end()) - inp.data();
+		return reaction(inp.take(n), inp.drop(n));
+	};
+
+	return take_while_impl << std::move(c);
+}
+
+Parser<cursor> fcl::take_while1(char_class c)
+{
+	const static function<Reaction<cursor>, char_class, cursor> take_while1_impl =
+		[](char_class c1, cursor inp)->Reaction<cursor>
+	{
+		size_t n = c1.scan(inp.data(), inp.end()) - inp.data();
+		if (n == 0) return Nothing();
+		return reaction(inp.take(n), inp.drop(n));
+	};
+
+	return take_while1_impl << std::move(c);
 }
 
-Reaction<char> fcl::digit19(std::string inp)
+Reaction<char> fcl::digit(cursor inp)
 {
-	const static auto P = sat([](char c)->bool {return isdigit(c) != 0 && c != '0'; });
+	const static auto P = sat(digits());
 	return parse(P, std::move(inp));
 }
 
-Reaction<char> fcl::hexdecimal(std::string inp)
+Reaction<char> fcl::digit19(cursor inp)
 {
-	const static auto P = sat([](char c)->bool {return isxdigit(c) != 0; });
+	const static auto P = sat(char_class::range('1', '9'));
 	return parse(P, std::move(inp));
 }
 
-Reaction<char> fcl::lower(std::string inp)
+Reaction<char> fcl::hexdecimal(cursor inp)
 {
-	const static auto P = sat([](char c)->bool {return islower(c) != 0; });
+	const static auto P = sat(hexdigits());
 	return parse(P, std::move(inp));
 }
 
-Reaction<char> fcl::upper(std::string inp)
+Reaction<char> fcl::lower(cursor inp)
 {
-	const static auto P = sat([](char c)->bool {return isupper(c) != 0; });
+	const static auto P = sat(lowers());
 	return parse(P, std::move(inp));
 }
 
-Reaction<char> fcl::letter(std::string inp)
+Reaction<char> fcl::upper(cursor inp)
 {
-	const static auto P = sat([](char c)->bool {return isalpha(c) != 0; });
+	const static auto P = sat(uppers());
 	return parse(P, std::move(inp));
 }
 
-Reaction<char> fcl::alphanumeric(std::string inp)
+Reaction<char> fcl::letter(cursor inp)
 {
-	const static auto P = sat([](char c)->bool {return isalnum(c) != 0; });
+	const static auto P = sat(letters());
 	return parse(P, std::move(inp));
 }
 
-Parser<char> fcl::character(char c)
+Reaction<char> fcl::alphanumeric(cursor inp)
 {
-	const static auto char_equal = function<bool, char, char>([](char a, char b)-> bool {return a == b; });
-	return sat(char_equal << c);
+	const static auto P = sat(alphanumerics());
+	return parse(P, std::move(inp));
 }
 
+Parser<char> fcl::character(char c) { return sat(char_class::of(std::string(1, c))); }
+
 std::string fcl::one_char_str(char c) { return std::string(1, c); }
 
 Parser<std::string> fcl::string(std::string str)
@@ -95,28 +237,25 @@ Parser<std::string> fcl::string(std::string str)
 		Fcons;
 }
 
-Reaction<std::string> fcl::ident(std::string inp)
+Reaction<std::string> fcl::ident(cursor inp)
 {
-	const static auto P =
-		lower >>=
-		any(alphanumeric) >>=
-		function<std::string, char, std::string>(cons_str)
-		;
-
-	return parse(P, std::move(inp));
+	//a lower case letter and the alphanumeric run after it, scanned in one step
+	if (inp.empty() || !lowers().contains(inp.head())) return Nothing();
+	size_t n = alphanumerics().scan(inp.data() + 1, inp.end()) - inp.data();
+	return reaction(std::string(inp.data(), n), inp.drop(n));
 }
 
-Reaction<int> fcl::nat(std::string inp)
+Reaction<int> fcl::nat(cursor inp)
 {
 	const static auto P =
-		some(Parser<char>(digit)) >>=
-		function<int, std::string>([](std::string str)->int {return std::stoi(str); })
+		take_while1(digits()) >>=
+		function<int, cursor>([](cursor digits)->int {return std::stoi(digits.str()); })
 		;
 
 	return parse(P, std::move(inp));
 }
 
-Reaction<int> fcl::inte(std::string inp)
+Reaction<int> fcl::inte(cursor inp)
 {
 	const static auto P =
 		(
@@ -131,28 +270,28 @@ Reaction<int> fcl::inte(std::string inp)
 	return parse(P, std::move(inp));
 }
 
-Reaction<na> fcl::space(std::string inp)
+Reaction<na> fcl::space(cursor inp)
 {
 	const static auto P =
-		any(sat(function<bool, char>([](char c)->bool { return isspace(c); }))) >>
+		take_while(spaces()) >>
 		Injector<Parser>::pure<na>(na())
 		;
 	return parse(P, std::move(inp));
 }
 
-Reaction<std::string> fcl::identifier(std::string inp)
+Reaction<std::string> fcl::identifier(cursor inp)
 {
 	const static auto P = token<std::string>(ident);
 	return parse(P, std::move(inp));
 }
 
-Reaction<int> fcl::natural(std::string inp)
+Reaction<int> fcl::natural(cursor inp)
 {
 	const static auto P = token<int>(nat);
 	return parse(P, std::move(inp));
 }
 
-Reaction<int> fcl::integer(std::string inp)
+Reaction<int> fcl::integer(cursor inp)
 {
 	const static auto P = token<int>(inte);
 	return parse(P, std::move(inp));
@@ -167,16 +306,22 @@ pair<char, std::string> fcl::uncons_str(std::string str)
 	return std::make_pair<char, std::string>(std::move(str[0]), str.substr(1, -1));
 }
 
+pair<char, cursor> fcl::uncons_str(cursor inp)
+{
+	char c = inp.head();
+	return std::make_pair<char, cursor>(std::move(c), inp.tail());
+}
+
 std::string fcl::concat_str(std::string a, std::string b) { return a + b; }
 
 Parser<std::string> fcl::maybe_one(Parser<char> p)
 {
-	const static function<Reaction<std::string>, Parser<char>, std::string> maybe_one_impl =
-		[](Parser<char> p1, std::string inp)->Reaction<std::string>
+	const static function<Reaction<std::string>, Parser<char>, cursor> maybe_one_impl =
+		[](Parser<char> p1, cursor inp)->Reaction<std::string>
 	{
 		auto r = parse(p1, inp);
 		if (isNothing(r)) return reaction<std::string>("", std::move(inp));
-		auto pair = fromJust(r);
+		auto pair = fromJust(std::move(r));
 		return reaction<std::string>(std::string(1, pair.first), std::move(pair.second));
 	};
 
@@ -185,22 +330,21 @@ Parser<std::string> fcl::maybe_one(Parser<char> p)
 
 Parser<std::string> fcl::any(Parser<char> p)
 {
-	const static function<Reaction<std::string>, Parser<char>, std::string> any_impl =
-		[](Parser<char> p, std::string inp)->Reaction<std::string>
+	const static function<Reaction<std::string>, Parser<char>, cursor> any_impl =
+		[](Parser<char> p, cursor inp)->Reaction<std::string>
 	{
 		auto r = parse(p, inp);
 		if (isNothing(r))
 			return reaction<std::string>("", std::move(inp));
-		auto pair = fromJust(r);
+		auto pair = fromJust(std::move(r));
 		std::string ans = "";
-		std::string inpn = "";
 		while (true)
 		{
 			ans += pair.first;
-			inpn = std::move(pair.second);
-			r = parse(p, inpn);
-			if (isNothing(r)) return reaction<std::string>(std::move(ans), std::move(inpn));
-			pair = fromJust(r);
+			inp = std::move(pair.second);
+			r = parse(p, inp);
+			if (isNothing(r)) return reaction<std::string>(std::move(ans), std::move(inp));
+			pair = fromJust(std::move(r));
 		}
 	};
 
@@ -216,40 +360,65 @@ Parser<std::string> fcl::some(Parser<char> p)
 		Mcons;
 }
 
+Parser<std::string> fcl::any(char_class c)
+{
+	const static auto Fstr = function<std::string, cursor>([](cursor run)->std::string {return run.str(); });
+	return take_while(std::move(c)) >>= Fstr;
+}
+
+Parser<std::string> fcl::some(char_class c)
+{
+	const static auto Fstr = function<std::string, cursor>([](cursor run)->std::string {return run.str(); });
+	return take_while1(std::move(c)) >>= Fstr;
+}
+
 
 #ifdef PARSER_CPP
 
-Reaction<int> fcl::expr(std::string inp)
+//term and factor are tried twice at the same position, memo makes the retry a lookup
+Reaction<int> fcl::memo_term(cursor inp)
+{
+	const static auto P = memo(Parser<int>(term));
+	return parse(P, std::move(inp));
+}
+
+Reaction<int> fcl::memo_factor(cursor inp)
+{
+	const static auto P = memo(Parser<int>(factor));
+	return parse(P, std::move(inp));
+}
+
+Reaction<int> fcl::expr(cursor inp)
 {
 	const static auto P =
 		(
-			Parser<int>(term) >>=
+			Parser<int>(memo_term) >>=
 			character('+') >>
-			Parser<int>(expr) >>=
+			commit(Parser<int>(expr)) >>=
 			function<int, int, int>(add)
 			)
 		||
-		Parser<int>(term)
+		Parser<int>(memo_term)
 		;
 
 	return parse(P, std::move(inp));
 }
 
-Reaction<int> fcl::term(std::string inp)
+Reaction<int> fcl::term(cursor inp)
 {
 	const static auto P =
-		(Parser<int>(factor) >>=
+		(Parser<int>(memo_factor) >>=
 			character('*') >>
-			Parser<int>(term) >>=
+			commit(Parser<int>(term)) >>=
 			function<int, int, int>(mul))
 		||
-		Parser<int>(factor)
+		Parser<int>(memo_factor)
 		;
 
 	return parse(P, std::move(inp));
 }
 
-Reaction<int> fcl::factor(std::string inp)
+Reaction<int> fcl::factor(cursor inp)
 {
 	const static auto P =
 		(
@@ -259,8 +428,8 @@ Reaction<int> fcl::factor(std::string inp)
 		||
 		(
 			character('(') >>
-			Parser<int>(expr) >>=
-			character(')') >>
+			commit(Parser<int>(expr)) >>=
+			commit(character(')')) >>
 			function<int, int>(id<int>)
 			)
 		;
@@ -270,6 +439,7 @@ Reaction<int> fcl::factor(std::string inp)
 
 int fcl::eval(std::string inp)
 {
+	packrat scope;
 	auto reaction = parse(Parser<int>(expr), inp);
 	if (isNothing(reaction)) throw std::exception("parse failed");
 	return fromJust(reaction).first;
@@ -290,6 +460,32 @@ int main()
 	display_expr("1+2+3");
 	display_expr("1+2*3");
 	display_expr("(1+2)*3");
+
+	//every level of nesting doubled the work without memoization
+	std::string nested = "1";
+	for (int i = 0; i < 200; ++i) nested = "(" + nested + "+1)*1";
+	std::cout << "200 nested parentheses: " << eval(nested) << std::endl;
+
+	{
+		packrat scope;
+		parse(Parser<int>(expr), "2*(3+4)");
+		std::cout << "remembered positions: " << scope.size() << std::endl;
+		//same length and same scope, but another buffer, none of the first results apply
+		std::cout << "second input in the scope: " << parse(Parser<int>(expr), "5*(6+7)") << std::endl;
+	}
+	std::cout << "outside a packrat scope: " << parse(Parser<int>(expr), "2*(3+4)") << std::endl;
+
+	//after '+' or '(' the rest has to follow, nothing falls back to the shorter parse
+	try { eval("1+(2*"); }
+	catch (parse_error& e) { std::cout << "committed failure at " << e.position << ": " << e.what() << std::endl; }
+	std::cout << "attempt: " << parse(attempt(Parser<int>(expr)), "1+") << std::endl;
+
+	//runs longer than 16 characters go through the vector scan
+	display_parse(take_while(char_class::range('a', 'z')), "abcdefghijklmnopqrstuvwxyz0123");
+	display_parse(take_while1(char_class::of("xy")), "zxy");
+	display_parse(some(~char_class::of(",")), "a longer field, the next one");
+	display_parse(Parser<std::string>(identifier), "                    camelCase42 rest");
+	display_parse(Parser<int>(natural), "  12345678 ");
 }
 
 #endif
\ No newline at end of file
@@ -31,6 +31,14 @@
 *	refactor according to other dependents
 *	August 25
 *	final review for publish
+*	October 18
+*	parsers consume a cursor into a shared buffer instead of copying the remaining std::string
+*	parse_file parses a memory mapped file without reading it into a std::string
+*	opt-in packrat memoization with memo and packrat
+*	commit and attempt bound backtracking once a branch is recognised
+*	char_class lookup tables, take_while and take_while1 scan a whole run in one step
+*	combinators capture their parsers in a lambda instead of binding them as arguments
+*	sat takes its predicate by function_ref and turns it into a char_class
 *
 *
 */
@@ -40,43 +48,60 @@
 #define _PARSER_
 
 #include "prelude.h"
+#include "cursor.h"
+#include "mapped_file.h"
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 
 namespace fcl
 {
 
 	template<typename a>
-	using Reaction = Maybe<pair<a, std::string>>;
+	using Reaction = Maybe<pair<a, cursor>>;
+
+	//remaining input is shown as the string it still refers to
+	template<>
+	struct Show<cursor>
+	{
+		using pertain = std::true_type;
+		static std::string show(const cursor& value) { return Show<std::string>::show(value.str()); }
+	};
 
 	template<typename a>
 	struct Parser;
 
 	template<typename a>
-	Reaction<a> parse(const Parser<a>&, std::string);
+	Reaction<a> parse(const Parser<a>&, cursor);
 
 	template<typename a>
 	struct Parser
 	{
-		template<typename l, typename = std::enable_if_t<std::is_convertible<l, function<Reaction<a>, std::string>>::value>>
+		template<typename l, typename = std::enable_if_t<std::is_convertible<l, function<Reaction<a>, cursor>>::value>>
 		Parser(l lambda) :P(lambda) {}
-		friend Reaction<a> parse<>(const Parser<a>&, std::string);
+		friend Reaction<a> parse<>(const Parser<a>&, cursor);
 	private:
-		function<Reaction<a>, std::string> P;
+		function<Reaction<a>, cursor> P;
 	};
 
 	template<typename a>
-	Reaction<a> parse(const Parser<a>& p, std::string str) { return p.P(str); }
+	Reaction<a> parse(const Parser<a>& p, cursor inp) { return p.P(std::move(inp)); }
+
+	//parse a file straight from its memory mapping, the remaining input keeps the mapping alive
+	template<typename a>
+	Reaction<a> parse_file(const Parser<a>& p, const std::string& path) { return parse(p, map_file(path)); }
 
 	template<typename a>
-	Reaction<a> failure(std::string inp)
+	Reaction<a> failure(cursor inp)
 	{
 		const static Nothing nothing = Nothing();
 		return nothing;
 	}
 
 	template<typename a>
-	Reaction<a> reaction(a&& value, std::string&& inp)
+	Reaction<a> reaction(a&& value, cursor&& inp)
 	{
-		return std::make_pair<a, std::string>(std::forward<a>(value), std::forward<std::string>(inp));
+		return std::make_pair<a, cursor>(std::forward<a>(value), std::forward<cursor>(inp));
 	}
 
 	template<>
@@ -87,8 +112,8 @@ namespace fcl
 		template<typename a>
 		static Parser<a> pure(a&& value)
 		{
-			const static function<Reaction<a>, a, std::string> pure_impl =
-				[](a val, std::string inp)->Reaction<a>
+			const static function<Reaction<a>, a, cursor> pure_impl =
+				[](a val, cursor inp)->Reaction<a>
 			{
 				return reaction(std::move(val), std::move(inp));
 			};
@@ -105,31 +130,25 @@ namespace fcl
 		template<typename f, typename = std::enable_if_t<is_function<f>::value>>
 		static Parser<applied_type<f>> fmap(f&& f_, Parser<head_parameter<f>>&& pa)
 		{
-			const static function<Reaction<applied_type<f>>, f, Parser<head_parameter<f>>, std::string> fmap_impl =
-				[](f func, Parser<head_parameter<f>> pa, std::string inp)->Reaction<applied_type<f>>
+			return [func = std::forward<f>(f_), pa1 = std::move(pa)](cursor inp)->Reaction<applied_type<f>>
 			{
-				auto r = parse(pa, std::move(inp));
+				auto r = parse(pa1, std::move(inp));
 				if (isNothing(r)) return Nothing();
 				auto pair = fromJust(std::move(r));
 				return reaction(function_traits<f>::apply(func, std::move(pair.first)), std::move(pair.second));
 			};
-
-			return fmap_impl << std::forward<f>(f_) << std::forward<Parser<head_parameter<f>>>(pa);
 		}
 
 		template<typename f, typename = std::enable_if_t<is_function<f>::value>>
 		static Parser<monadic_applied_type<f>> monadic_fmap(const f& f_, Parser<last_parameter<f>>&& pa)
 		{
-			const static function<Reaction<monadic_applied_type<f>>, f, Parser<last_parameter<f>>, std::string> fmap_impl =
-				[](f func, Parser<last_parameter<f>> pa, std::string inp)->Reaction<monadic_applied_type<f>>
+			return [func = f_, pa1 = std::move(pa)](cursor inp)->Reaction<monadic_applied_type<f>>
 			{
-				auto r = parse(pa, std::move(inp));
+				auto r = parse(pa1, std::move(inp));
 				if (isNothing(r)) return Nothing();
 				auto pair = fromJust(std::move(r));
-				return reaction(function_traits<f>::monadic_apply(func,std::move(pair.first)), std::move(pair.second));
+				return reaction(function_traits<f>::monadic_apply(func, std::move(pair.first)), std::move(pair.second));
 			};
-
-			return fmap_impl << f_ << std::forward<Parser<last_parameter<f>>>(pa);
 		}
 	};
 
@@ -144,15 +163,12 @@ namespace fcl
 		template<typename a>
 		static Parser<a> alter(Parser<a>&& p, Parser<a>&& q)
 		{
-			const static function<Reaction<a>, Parser<a>, Parser<a>, std::string> alter_impl =
-				[](Parser<a> p1, Parser<a> q1, std::string inp)->Reaction<a>
+			return [p1 = std::move(p), q1 = std::move(q)](cursor inp)->Reaction<a>
 			{
 				auto r = parse(p1, inp);
 				if (isJust(r)) return r;
 				return parse(q1, std::move(inp));
 			};
-
-			return alter_impl << std::forward<Parser<a>>(p) << std::forward<Parser<a>>(q);
 		}
 	};
 
@@ -164,8 +180,7 @@ namespace fcl
 		template<typename f, typename = std::enable_if_t<is_function<f>::value>>
 		static Parser<monadic_applied_type<f>> sequence(Parser<f>&& pf, Parser<last_parameter<f>>&& pa)
 		{
-			const static function<Reaction<monadic_applied_type<f>>, Parser<last_parameter<f>>, Parser<f>, std::string> seq_impl =
-				[](Parser<last_parameter<f>> pa1, Parser<f> pf1, std::string inp)->Reaction<monadic_applied_type<f>>
+			return [pa1 = std::move(pa), pf1 = std::move(pf)](cursor inp)->Reaction<monadic_applied_type<f>>
 			{
 				auto ra = parse(pa1, std::move(inp));
 				if (isNothing(ra)) return Nothing();
@@ -175,42 +190,86 @@ namespace fcl
 				auto pairf = fromJust(std::move(rf));
 				return reaction(function_traits<f>::monadic_apply(pairf.first, std::move(paira.first)), std::move(pairf.second));
 			};
-
-			return seq_impl << std::forward<Parser<last_parameter<f>>>(pa) << std::forward<Parser<f>>(pf);
 		}
 
 		template<typename a, typename b>
 		static Parser<b> compose(Parser<a>&& p, Parser<b>&& q)
 		{
-			const static function<Reaction<b>, Parser<a>, Parser<b>, std::string> compose_impl =
-				[](Parser<a> p1, Parser<b> q1, std::string inp)->Reaction<b>
+			return [p1 = std::move(p), q1 = std::move(q)](cursor inp)->Reaction<b>
 			{
 				auto r = parse(p1, std::move(inp));
 				if (isNothing(r)) return Nothing();
 				return parse(q1, fromJust(std::move(r)).second);
 			};
-
-			return compose_impl << std::forward<Parser<a>>(p) << std::forward<Parser<b>>(q);
 		}
 	};
 
-	Reaction<char> item(std::string inp);
+	namespace details
+	{
+		//membership of every byte, plus a nibble table for 16 bytes at a time
+		//low[l] has bit h set when the byte h * 16 + l is a member, for h < 8
+		struct class_table
+		{
+			bool member[256];
+			unsigned char low[16];
+			bool ascii;
+		};
+	}
+
+	//a set of characters decided once when it is built, membership is one table lookup
+	struct char_class
+	{
+		char_class();
 
-	Parser<char> sat(function<bool, char> p);
+		//p is asked about every char value, negative ones included, and has to answer the same way each time
+		explicit char_class(function_ref<bool, char> p);
 
-	Reaction<char> digit(std::string inp);
+		static char_class range(char first, char last);
 
-	Reaction<char> digit19(std::string inp);
+		static char_class of(const std::string& chars);
 
-	Reaction<char> hexdecimal(std::string inp);
+		char_class operator|(const char_class& other)const;
 
-	Reaction<char> lower(std::string inp);
+		char_class operator~()const;
 
-	Reaction<char> upper(std::string inp);
+		bool contains(char c)const { return table_->member[static_cast<unsigned char>(c)]; }
+
+		//first character in [p, last) that is not a member
+		const char* scan(const char* p, const char* last)const;
+
+	private:
+		std::shared_ptr<details::class_table> table_;
+
+		void build();
+	};
 
-	Reaction<char> letter(std::string inp);
+	Reaction<char> item(cursor inp);
 
-	Reaction<char> alphanumeric(std::string inp);
+	//p is asked once per char value up front and the parser keeps the resulting table
+	//so p has to be a pure predicate: no state, no side effects, defined for negative chars
+	Parser<char> sat(function_ref<bool, char> p);
+
+	Parser<char> sat(char_class c);
+
+	//the longest prefix made of c, as a cursor over the input instead of a copy
+	Parser<cursor> take_while(char_class c);
+
+	//take_while that needs at least one character
+	Parser<cursor> take_while1(char_class c);
+
+	Reaction<char> digit(cursor inp);
+
+	Reaction<char> digit19(cursor inp);
+
+	Reaction<char> hexdecimal(cursor inp);
+
+	Reaction<char> lower(cursor inp);
+
+	Reaction<char> upper(cursor inp);
+
+	Reaction<char> letter(cursor inp);
+
+	Reaction<char> alphanumeric(cursor inp);
 
 	Parser<char> character(char c);
 
@@ -218,19 +277,19 @@ namespace fcl
 
 	Parser<std::string> string(std::string str);
 
-	Reaction<std::string> ident(std::string inp);
+	Reaction<std::string> ident(cursor inp);
 
-	Reaction<int> nat(std::string inp);
+	Reaction<int> nat(cursor inp);
 
-	Reaction<int> inte(std::string inp);
+	Reaction<int> inte(cursor inp);
 
-	Reaction<na> space(std::string inp);
+	Reaction<na> space(cursor inp);
 
-	Reaction<std::string> identifier(std::string inp);
+	Reaction<std::string> identifier(cursor inp);
 
-	Reaction<int> natural(std::string inp);
+	Reaction<int> natural(cursor inp);
 
-	Reaction<int> integer(std::string inp);
+	Reaction<int> integer(cursor inp);
 
 	Parser<std::string> symbol(std::string str);
 
@@ -238,6 +297,8 @@ namespace fcl
 
 	pair<char, std::string> uncons_str(std::string str);
 
+	pair<char, cursor> uncons_str(cursor inp);
+
 	std::string concat_str(std::string, std::string);
 
 	Parser<std::string> maybe_one(Parser<char> p);
@@ -246,6 +307,10 @@ namespace fcl
 
 	Parser<std::string> some(Parser<char> p);
 
+	Parser<std::string> any(char_class c);
+
+	Parser<std::string> some(char_class c);
+
 	template<typename a>
 	Parser<list<a>> maybe_one(Parser<a> p);
 
@@ -255,6 +320,80 @@ namespace fcl
 	template<typename a>
 	Parser<list<a>> some(Parser<a> p);
 
+	namespace details
+	{
+		//an entry holds on to the owner of its input, so a new buffer cannot reuse the address while the entry lives
+		struct memo_entry
+		{
+			size_t id;
+			const char* end;
+			std::shared_ptr<const void> owner;
+			std::shared_ptr<const void> result;
+		};
+
+		//results of memo parsers by input position
+		struct memo_table
+		{
+			std::unordered_map<const char*, std::vector<memo_entry>> entries;
+		};
+
+		//innermost packrat scope of this thread
+		inline memo_table*& current_memo()
+		{
+			thread_local memo_table* table = nullptr;
+			return table;
+		}
+
+		inline size_t next_memo_id()
+		{
+			static std::atomic<size_t> id(0);
+			return ++id;
+		}
+	}
+
+	//while a packrat object is alive, memo parsers on the same thread reuse their results
+	//so backtracking over memo parsers is linear in the input, left recursion is still not allowed
+	//results are matched by position, end and owner, input without an owner has to outlive the scope
+	struct packrat
+	{
+		packrat() :table_(), previous_(details::current_memo()) { details::current_memo() = &table_; }
+
+		packrat(const packrat&) = delete;
+
+		packrat& operator=(const packrat&) = delete;
+
+		~packrat() { details::current_memo() = previous_; }
+
+		//input positions with a remembered result
+		size_t size()const { return table_.entries.size(); }
+
+	private:
+		details::memo_table table_;
+		details::memo_table* previous_;
+	};
+
+	//remember the reaction of p at every input position, only inside a packrat scope
+	template<typename a>
+	Parser<a> memo(Parser<a> p);
+
+	//a failure after a commit point, no alternative is tried until the nearest attempt
+	struct parse_error :public std::exception
+	{
+		parse_error(size_t pos) :std::exception("error: parse failed after a commit point."), position(pos) {}
+
+		//offset of the committed input from the start of its buffer
+		size_t position;
+	};
+
+	//p has to succeed, its failure is thrown as parse_error instead of returned
+	//put it after the prefix that tells a branch apart, e.g. character('(') >> commit(expr)
+	template<typename a>
+	Parser<a> commit(Parser<a> p);
+
+	//a committed failure inside p becomes Nothing again
+	template<typename a>
+	Parser<a> attempt(Parser<a> p);
+
 	template<typename a>
 	Parser<a> token(Parser<a> p)
 	{
@@ -273,11 +412,15 @@ namespace fcl
 
 	int mul(int a, int b) { return a * b; }
 
-	Reaction<int> expr(std::string inp);
+	Reaction<int> expr(cursor inp);
+
+	Reaction<int> term(cursor inp);
 
-	Reaction<int> term(std::string inp);
+	Reaction<int> factor(cursor inp);
 
-	Reaction<int> factor(std::string inp);
+	Reaction<int> memo_term(cursor inp);
+
+	Reaction<int> memo_factor(cursor inp);
 
 	int digitToInt(char c) { return c - '0'; }
 
@@ -287,15 +430,56 @@ namespace fcl
 
 	//implenmentation
 
+	template<typename a>
+	inline Parser<a> memo(Parser<a> p)
+	{
+		return [id = details::next_memo_id(), p1 = std::move(p)](cursor inp)->Reaction<a>
+		{
+			details::memo_table* table = details::current_memo();
+			if (table == nullptr) return parse(p1, std::move(inp));
+			const char* position = inp.data();
+			const char* end = inp.end();
+			std::shared_ptr<const void> owner = inp.owner();
+			for (const auto& e : table->entries[position])
+				if (e.id == id && e.end == end && e.owner == owner) return *static_cast<const Reaction<a>*>(e.result.get());
+			auto r = std::make_shared<const Reaction<a>>(parse(p1, std::move(inp)));
+			//p1 may have added entries for this position meanwhile
+			table->entries[position].push_back(details::memo_entry{ id, end, std::move(owner), r });
+			return *r;
+		};
+	}
+
+	template<typename a>
+	inline Parser<a> commit(Parser<a> p)
+	{
+		return [p1 = std::move(p)](cursor inp)->Reaction<a>
+		{
+			size_t position = inp.position();
+			auto r = parse(p1, std::move(inp));
+			if (isNothing(r)) throw parse_error(position);
+			return r;
+		};
+	}
+
+	template<typename a>
+	inline Parser<a> attempt(Parser<a> p)
+	{
+		return [p1 = std::move(p)](cursor inp)->Reaction<a>
+		{
+			try { return parse(p1, std::move(inp)); }
+			catch (const parse_error&) { return Nothing(); }
+		};
+	}
+
 	template<typename a>
 	inline Parser<list<a>> maybe_one(Parser<a> p)
 	{
-		const static function<Reaction<list<a>>, Parser<a>, std::string> maybe_one_impl =
-			[](Parser<a> p1, std::string inp)->Reaction<list<a>>
+		const static function<Reaction<list<a>>, Parser<a>, cursor> maybe_one_impl =
+			[](Parser<a> p1, cursor inp)->Reaction<list<a>>
 		{
 			auto r = parse(p1, inp);
 			if (isNothing(r)) return reaction(list<a>(), std::move(inp));
-			auto pair = fromJust(r);
+			auto pair = fromJust(std::move(r));
 			return reaction(list<a>{pair.first}, std::move(pair.second));
 		};
 
@@ -305,22 +489,21 @@ namespace fcl
 	template<typename a>
 	inline Parser<list<a>> any(Parser<a> p)
 	{
-		const static function<Reaction<list<a>>, Parser<a>, std::string> any_impl =
-			[](Parser<a> p, std::string inp) ->Reaction<list<a>>
+		const static function<Reaction<list<a>>, Parser<a>, cursor> any_impl =
+			[](Parser<a> p, cursor inp) ->Reaction<list<a>>
 		{
 			auto r = parse(p, inp);
 			if (isNothing(r))
 				return reaction(list<a>(), std::move(inp));
-			auto pair = fromJust(r);
+			auto pair = fromJust(std::move(r));
 			list<a> ans;
-			std::string inpn;
 			while (true)
 			{
 				ans.push_back(std::move(pair.first));
-				inpn = std::move(pair.second);
-				r = parse(p, inpn);
-				if (isNothing(r)) return reaction(std::move(ans), std::move(inpn));
-				pair = fromJust(r);
+				inp = std::move(pair.second);
+				r = parse(p, inp);
+				if (isNothing(r)) return reaction(std::move(ans), std::move(inp));
+				pair = fromJust(std::move(r));
 			}
 		};
 		return any_impl << p;
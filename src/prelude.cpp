@@ -90,6 +90,11 @@ int main()
 	std::cout << "Just increment << Just 5: " << (Maybe<function<int, int>>(increment) <<= Maybe<int>(5)) << std::endl;
 	std::cout << "Nothing >>= Just increment: " << (Maybe<int>() >>= Maybe<function<int, int>>(increment)) << std::endl;
 	std::cout << "Just 5 >>= Just increment: " << (Maybe<int>(5) >>= Maybe<function<int, int>>(increment)) << std::endl;
+	std::cout << "Nothing >> Just 5: " << (Maybe<int>() >> Maybe<int>(5)) << std::endl;
+	std::cout << "Just 7 >> Just 5: " << (Maybe<int>(7) >> Maybe<int>(5)) << std::endl;
+	Maybe<std::string> ms = std::string("moved out");
+	std::cout << "fromJust by move: " << fromJust(std::move(ms)) << std::endl;
+	std::cout << "fromMaybe 0 Nothing: " << fromMaybe(0, m1) << std::endl;
 	auto t3 = std::make_tuple<int, int, int>(1, 2, 3);
 	std::cout << "t3: " << t3 << std::endl;
 	Maybe<pair<int, std::string>> r = std::make_pair<int, std::string>(1, "content");
@@ -100,6 +105,8 @@ int main()
 	std::cout << "is_nothing Just 5: " << is_nothing(m) << std::endl;
 	std::cout << "maybe_add Nothing Just 5: " << maybe_add(m1, m) << std::endl;
 	std::cout << "maybe_add Just 7 Just 5: " << maybe_add(m3, m) << std::endl;
+	std::cout << "maybe 0 (*2) Just 5: " << maybe(0, [](int x) { return x * 2; }, m) << std::endl;
+	std::cout << "maybe 0 (*2) Nothing: " << maybe(0, [](int x) { return x * 2; }, m1) << std::endl;
 	data<int, float, char, std::string> tv1 = 1;
 	std::cout << "variant int: " << tv1 << std::endl;
 	tv1 = 2.0f;
@@ -36,6 +36,9 @@
 *	change pattern matching syntax and let pattern matching use Maybe
 *	August 25
 *	final review for publish
+*	October 18
+*	Maybe stores its value inline behind a one byte tag instead of a data<Nothing, Just<a>>
+*	maybe takes its function by function_ref
 *
 *
 */
@@ -325,24 +328,65 @@ namespace fcl
 	struct Nothing {};
 
 	//maybe implenmentation
+	//Just keeps its value inline next to a one byte tag, Nothing is just the tag
 	template<typename a>
 	struct Maybe
 	{
-		Maybe() :value(Nothing()) {}
+		Maybe() :just_(false) {}
 
-		Maybe(Just<a> just) :value(just) {}
-		Maybe(Nothing n) :value(n) {}
+		Maybe(Just<a> just) :just_(true) { new (&storage_) Just<a>(std::move(just)); }
+		Maybe(Nothing n) :just_(false) {}
 
-		Maybe(a v_) :value(Just<a>{v_}) {}
+		Maybe(a v_) :just_(true) { new (&storage_) Just<a>{ std::move(v_) }; }
+
+		Maybe(const Maybe& other) :just_(other.just_) { if (just_) new (&storage_) Just<a>(other.just()); }
+
+		Maybe(Maybe&& other) :just_(other.just_) { if (just_) new (&storage_) Just<a>(std::move(other.just())); }
+
+		Maybe& operator=(const Maybe& other)
+		{
+			if (&other != this)
+			{
+				reset();
+				if (other.just_) new (&storage_) Just<a>(other.just());
+				just_ = other.just_;
+			}
+			return *this;
+		}
+
+		Maybe& operator=(Maybe&& other)
+		{
+			if (&other != this)
+			{
+				reset();
+				if (other.just_) new (&storage_) Just<a>(std::move(other.just()));
+				just_ = other.just_;
+			}
+			return *this;
+		}
+
+		~Maybe() { reset(); }
 
 		friend variant_traits<Maybe<a>>;
 
 	private:
-		data<Nothing, Just<a>> value;
+		std::aligned_storage_t<sizeof(Just<a>), alignof(Just<a>)> storage_;
+		bool just_;
+
+		Just<a>& just() { return *reinterpret_cast<Just<a>*>(&storage_); }
+
+		const Just<a>& just()const { return *reinterpret_cast<const Just<a>*>(&storage_); }
+
+		void reset()
+		{
+			if (just_) just().~Just<a>();
+			just_ = false;
+		}
 	};
 
+	//f is only called here, any callable is taken by reference
 	template<typename a, typename b>
-	b maybe(b default_r, const function<b, a>& f, const Maybe<a>& ma)
+	b maybe(b default_r, function_ref<std::decay_t<b>, std::decay_t<a>> f, const Maybe<a>& ma)
 	{
 		if (isNothing(ma)) return default_r;
 		return f(fromJust(ma));
@@ -357,11 +401,12 @@ namespace fcl
 	template<typename a>
 	a fromJust(const Maybe<a>& ma) { return variant_traits<Maybe<a>>::template get<Just<a>>(ma).value; }
 
+	//moves the value out, prefer this one whenever the Maybe is not used afterwards
 	template<typename a>
 	a fromJust(Maybe<a>&& ma) { return variant_traits<Maybe<a>>::template move<Just<a>>(ma).value; }
 
 	template<typename a>
-	a fromMaybe(a default_r, const Maybe<a>& ma) { isNothing(ma) ? default_r : variant_traits<Maybe<a>>::template get<Just<a>>(ma).value; }
+	a fromMaybe(a default_r, const Maybe<a>& ma) { return isNothing(ma) ? default_r : variant_traits<Maybe<a>>::template get<Just<a>>(ma).value; }
 
 	//Maybe variant traits implenmentation
 	template<typename a>
@@ -376,16 +421,27 @@ namespace fcl
 		template<typename b>
 		using elem = TMP::elem<TMP::list<Nothing, Just<a>>, b>;
 
-		using D = data<Nothing, Just<a>>;
-
 		template<typename b>
-		static bool is_of(const def& maybe) { return variant_traits<D>::template is_of<b>(maybe.value); }
+		static bool is_of(const def& maybe) { return std::is_same<b, Just<a>>::value ? maybe.just_ : std::is_same<b, Nothing>::value && !maybe.just_; }
 
 		template<typename b>
-		static b&& move(def& maybe) { return variant_traits<D>::template move<b>(maybe.value); }
+		static b&& move(def& maybe) { return std::move(const_cast<b&>(get<b>(maybe))); }
 
 		template<typename b>
-		static const b& get(const def& maybe) { return variant_traits<D>::template get<b>(maybe.value); }
+		static const b& get(const def& maybe)
+		{
+			if (!is_of<b>(maybe)) throw std::exception("error: type mismatch.");
+			return *static_cast<const b*>(address(maybe, static_cast<b*>(nullptr)));
+		}
+
+	private:
+		static const void* address(const def& maybe, Just<a>*) { return &maybe.storage_; }
+
+		static const void* address(const def& maybe, Nothing*)
+		{
+			static Nothing nothing;
+			return &nothing;
+		}
 	};
 
 	//Maybe Eq typeclass implenmentation
@@ -443,7 +499,7 @@ namespace fcl
 		using pertain = std::true_type;
 
 		template<typename a>
-		static Maybe<a> pure(a&& ma) { return Maybe<a>(ma); }
+		static Maybe<a> pure(a&& ma) { return Maybe<a>(std::forward<a>(ma)); }
 
 	};
 
@@ -492,7 +548,7 @@ namespace fcl
 		static Maybe<a> empty() { return Nothing(); }
 
 		template<typename a>
-		static Maybe<a> alter(Maybe<a>&& p, Maybe<a>&& q) { if (isJust(p)) return p; return q; }
+		static Maybe<a> alter(Maybe<a>&& p, Maybe<a>&& q) { if (isJust(p)) return std::move(p); return std::move(q); }
 	};
 
 	//Maybe Monad typeclass implenmentation
@@ -511,7 +567,8 @@ namespace fcl
 		template<typename a, typename b>
 		static Maybe<b> compose(Maybe<a>&& p, Maybe<b>&& q)
 		{
-			return q;
+			if (isNothing(p)) return Nothing();
+			return std::move(q);
 		}
 	};
 
@@ -593,27 +650,13 @@ namespace fcl
 		using pertain = std::true_type;
 		using V = variant<a, b, rest...>;
 
-		template<size_t I, typename = std::enable_if_t<I == TMP::length<V>::value>>
-		static std::string show_impl(const V& value)
-		{
-			static_assert(details::are_show<a, b, rest...>::value, "variant<a, b, rest...> is not of Show because a, b, rest... are not all of Show.");
-			throw std::exception("error: type mismatch.");
-		}
-
-		template<size_t I, typename = std::enable_if_t<I != TMP::length<V>::value>, size_t = 0>
-		static std::string show_impl(const V& value)
-		{
-			static_assert(details::are_show<a, b, rest...>::value, "variant<a, b, rest...> is not of Show because a, b, rest... are not all of Show.");
-			using T = typename TMP::index<V, I>::type;
-			if (variant_traits<V>::template is_of<T>(value))
-				return util::type<T>::infer() + " " + Show<T>::show(variant_traits<V>::template get<T>(value));
-			return show_impl<I + 1>(value);
-		}
+		template<typename T>
+		static std::string show_alternative(const T& value) { return util::type<T>::infer() + " " + Show<T>::show(value); }
 
 		static std::string show(const V& value)
 		{
 			static_assert(details::are_show<a, b, rest...>::value, "variant<a, b, rest...> is not of Show because a, b, rest... are not all of Show.");
-			return show_impl<0>(value);
+			return variant_traits<V>::visit([](const auto& alternative) { return show_alternative(alternative); }, value);
 		}
 	};
 
@@ -41,6 +41,13 @@ int main()
 	std::cout << "v is nontrivial: " << VT<V1>::is_of<nontrivial>(v) << std::endl;
 	std::cout << "get v as nontrivial: " << VT<V1>::get<nontrivial>(v) << std::endl;
 
+	V1 v2(v);
+	std::cout << "copy v: " << VT<V1>::get<nontrivial>(v2) << std::endl;
+	V1 v3(std::move(v2));
+	std::cout << "move copy of v: " << VT<V1>::get<nontrivial>(v3) << std::endl;
+	v3 = std::string("string");
+	std::cout << "visit v3: " << VT<V1>::visit([](const auto& x) { return util::type<std::decay_t<decltype(x)>>::infer(); }, v3) << std::endl;
+
 	function<int, int> f(inc);
 	std::cout << "function test: " << f(5) << std::endl;
 	using V2 = variant<Nothing, function<int, int>>;
@@ -25,6 +25,7 @@
 *	int i1 = v.move<int>(); //v is ill-formed after this
 *	auto v2 = v;
 *	auto v3(v);
+*	std::string s = variant_traits<V>::visit([](const auto& x) { return Show<...>::show(x); }, v);
 *	//though not encouraged to use its own method outside of this package
 *	//use variant trait methods if possible
 *
@@ -40,6 +41,10 @@
 *	due to all the instantiations of copy and destruct method
 *	August 25
 *	final review for publish
+*	October 18
+*	back to in-place storage, this time an aligned buffer sized to the largest alternative
+*	copy, move, destroy and visit dispatch through static tables indexed by index_
+*	so no alternative is ever heap allocated and no runtime bisection is needed
 *
 *
 */
@@ -50,6 +55,23 @@
 
 #include "meta.h"
 #include <exception>
+#include <new>
+
+namespace details
+{
+	//type erased operations on a single alternative, one table entry per type
+	template<typename T>
+	void destroy_as(void* self) { static_cast<T*>(self)->~T(); }
+
+	template<typename T>
+	void copy_as(void* self, const void* other) { new (self) T(*static_cast<const T*>(other)); }
+
+	template<typename T>
+	void move_as(void* self, void* other) { new (self) T(std::move(*static_cast<T*>(other))); }
+
+	template<typename T, typename r, typename f>
+	r visit_as(f& func, const void* self) { return func(*static_cast<const T*>(self)); }
+}
 
 namespace fcl
 {
@@ -61,21 +83,21 @@ namespace fcl
 
 		friend variant_traits<variant<a, b, rest...>>;
 
-		variant() :index_(-1), ptr_(nullptr) {}
+		variant() :index_(-1) {}
 
 		template<typename T, typename = std::enable_if_t<TMP::elem<list, T>::value>>
-		variant(T value) : index_(TMP::elem_index<T, list>::value), ptr_(new T(std::move(value))) {}
+		variant(T value) : index_(TMP::elem_index<T, list>::value) { new (&storage_) T(std::move(value)); }
 
-		variant(const variant& other) :index_(other.index_) { copy_op(other.ptr_); }
+		variant(const variant& other) :index_(-1) { copy_op(other); }
 
-		variant(variant&& other) :index_(other.index_), ptr_(other.ptr_) { other.ptr_ = nullptr; }
+		variant(variant&& other) :index_(-1) { move_op(other); }
 
-		template<typename U, typename std::enable_if_t<TMP::elem<list, U>::value>>
+		template<typename U, typename = std::enable_if_t<TMP::elem<list, U>::value>>
 		variant& operator=(U value)
 		{
-			~variant();
+			destroy_op();
+			new (&storage_) U(std::move(value));
 			index_ = TMP::elem_index<U, list>::value;
-			ptr_ = new U(std::move(value));
 			return *this;
 		}
 
@@ -83,82 +105,50 @@ namespace fcl
 		{
 			if (&other != this)
 			{
-				index_ = other.index_;
-				copy_op(other.ptr_);
+				destroy_op();
+				copy_op(other);
 			}
 			return *this;
 		}
 
 		variant& operator=(variant&& other)
 		{
-			index_ = other.index_;
-			ptr_ = other.ptr_;
-			other.ptr_ = nullptr;
+			if (&other != this)
+			{
+				destroy_op();
+				move_op(other);
+			}
 			return *this;
 		}
 
-		~variant();
+		~variant() { destroy_op(); }
 
 
 	private:
 
-		void * ptr_;
+		std::aligned_union_t<0, a, b, rest...> storage_;
 		int index_;
 
-		template<typename U, typename std::enable_if_t<TMP::elem<list, U>::value>>
-		variant(U* ptr) :index_(TMP::elem_index<U, list>::value), ptr_(ptr) {}
-
-		//bisection search convert runtime int to a compile-time one
-		//might take a while if variant contains a lot of types
-		//for instance for a variant of 5, deallocation would means 5 destruct() and 11 try_destruct()
-		//adding copy methods gives us 32 different methods
-		template<int N, int M>
-		void try_destruct(int i)
+		//a moved-from variant keeps its index and a moved-from value, destroyed as usual
+		void destroy_op()
 		{
-			constexpr int pivot = (N + M) / 2;
-			if (i == pivot)
-				destruct<pivot>();
-			else if (i > pivot)
-				try_destruct<pivot, M>(i);
-			else try_destruct<N, pivot>(i);
+			static void(*const table[])(void*) = { &details::destroy_as<a>, &details::destroy_as<b>, &details::destroy_as<rest>... };
+			if (index_ >= 0) table[index_](&storage_);
+			index_ = -1;
 		}
 
-		template<int N>
-		void destruct()
+		void copy_op(const variant& other)
 		{
-			typename TMP::index<list, N>::type* actual = (typename TMP::index<list, N>::type*)ptr_;
-			delete actual;
-			ptr_ = nullptr;
-		}
-
-		void copy_op(void* ptr)
-		{
-			if (index_ == 0)
-			{
-				copy<0>(ptr);
-				return;
-			}
-			constexpr int last = TMP::length<list>::value - 1;
-			if (index_ == last) copy<last>(ptr);
-			else try_copy<0, last>(ptr);
-		}
-
-		template<int N>
-		void copy(void* ptr)
-		{
-			typename TMP::index<list, N>::type* actual = (typename TMP::index<list, N>::type*)ptr;
-			ptr_ = new typename TMP::index<list, N>::type(*actual);
+			static void(*const table[])(void*, const void*) = { &details::copy_as<a>, &details::copy_as<b>, &details::copy_as<rest>... };
+			if (other.index_ >= 0) table[other.index_](&storage_, &other.storage_);
+			index_ = other.index_;
 		}
 
-		template<int N, int M>
-		void try_copy(void* ptr)
+		void move_op(variant& other)
 		{
-			constexpr int pivot = (N + M) / 2;
-			if (index_ == pivot)
-				copy<pivot>(ptr);
-			else if (index_ > pivot)
-				try_copy<pivot, M>(ptr);
-			else try_copy<N, pivot>(ptr);
+			static void(*const table[])(void*, void*) = { &details::move_as<a>, &details::move_as<b>, &details::move_as<rest>... };
+			if (other.index_ >= 0) table[other.index_](&storage_, &other.storage_);
+			index_ = other.index_;
 		}
 	};
 
@@ -188,32 +178,25 @@ namespace fcl
 		static T&& move(def& var)
 		{
 			if (!is_of<T>(var))  throw std::exception("error: type mismatch.");
-			T* actual = (T*)var.ptr_;
-			return std::move(*actual);
+			return std::move(*reinterpret_cast<T*>(&var.storage_));
 		}
 
 		template<typename T>
 		static const T& get(const def& var)
 		{
 			if (!is_of<T>(var))  throw std::exception("error: type mismatch.");
-			T* actual = (T*)var.ptr_;
-			return *actual;
+			return *reinterpret_cast<const T*>(&var.storage_);
 		}
-	};
 
-	//implenmetaion of dtor
-	template<typename a, typename b, typename ...rest>
-	inline variant<a, b, rest...>::~variant()
-	{
-		if (index_ == 0)
+		//call func with the contained alternative, func has to accept every alternative with one return type
+		template<typename f, typename r = decltype(std::declval<f&>()(std::declval<const a&>()))>
+		static r visit(f&& func, const def& var)
 		{
-			destruct<0>();
-			return;
+			static r(*const table[])(f&, const void*) = { &details::visit_as<a, r, f>, &details::visit_as<b, r, f>, &details::visit_as<rest, r, f>... };
+			if (var.index_ < 0) throw std::exception("error: visiting an empty variant.");
+			return table[var.index_](func, &var.storage_);
 		}
-		constexpr int last = TMP::length<list>::value - 1;
-		if (index_ == last) destruct<last>();
-		else try_destruct<0, last>(index_);
-	}
+	};
 }
 
 #endif
\ No newline at end of file